@@ -0,0 +1,97 @@
+/**
+ * H6N Software Development Kit
+ * Copyright (c) 2019 H6N Technologies, LLC. All rights reserved.
+ *
+ * This file is subject to the terms and conditions as defined in
+ * your H6N Technologies license agreement. THIS IS NOT OPEN-SOURCE
+ * OR FREE SOFTWARE. You MUST have a license to use or redistribute
+ * these files in source or binary form in any way.
+ */
+
+#ifndef _H6NSDK_ADMISSION_H
+#define _H6NSDK_ADMISSION_H
+
+#include <libh6n/common.h>
+#include <libh6n/interfaces.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returned by the admission functions when the connection may proceed
+#define H6N_ADMISSION_ADMITTED 0
+
+// Returned by the admission functions when the subnet will never be refilled (refillPerSecond is zero)
+#define H6N_ADMISSION_NEVER 0xFFFFFFFFu
+
+/**
+ * Connection admission policy. Addresses are grouped into subnets by prefix length, and each subnet is given a token
+ * bucket that holds at most `burst` registrations and refills at `refillPerSecond`.
+ *
+ * Once `maxSubnets` subnets are being tracked, any further subnets are hashed onto a small, fixed set of overflow
+ * buckets until idle subnets can be pruned, which bounds memory use during a join storm from many distinct networks.
+ * Untracked subnets that hash to the same overflow bucket share its tokens, so a busy untracked network can delay
+ * the few others it collides with, but not every untracked network.
+ */
+typedef struct _H6N_AdmissionPolicy {
+	unsigned int ipv4PrefixLength;
+	unsigned int ipv6PrefixLength;
+	unsigned int burst;
+	unsigned int refillPerSecond;
+	unsigned int maxSubnets;
+} H6N_AdmissionPolicy;
+
+typedef struct _H6N_AdmissionFilter H6N_AdmissionFilter;
+
+/**
+ * Creates a per-subnet admission filter. The filter is thread-safe.
+ *
+ * @param policy the policy to apply, which is copied
+ * @return the new filter, or 0 if the policy is invalid (a prefix length out of range, or a zero burst or subnet count)
+ */
+H6N_AdmissionFilter* Admission_createFilter(const H6N_AdmissionPolicy* policy);
+
+/**
+ * Frees a filter created by Admission_createFilter.
+ */
+void Admission_freeFilter(H6N_AdmissionFilter* filter);
+
+/**
+ * Creates an IPv4-mapped IPv6 address (::ffff:a.b.c.d), which is how IPv4 addresses are passed to the filter.
+ * Addresses are stored in network byte order in the `bytes` field of H6N_IPV6.
+ */
+H6N_IPV6 Admission_ipv4(uint8_t a, uint8_t b, uint8_t c, uint8_t d);
+
+/**
+ * Takes a token from the bucket of the subnet that contains `address`.
+ *
+ * @param filter the filter to check against
+ * @param address the remote address of the connecting player
+ * @return H6N_ADMISSION_ADMITTED if the connection may proceed, otherwise the number of milliseconds until the subnet
+ *         will have a token available (or H6N_ADMISSION_NEVER). Callers may queue the connection for that long or
+ *         reject it outright.
+ */
+unsigned int Admission_check(H6N_AdmissionFilter* filter, H6N_IPV6 address);
+
+/**
+ * Same as Admission_check, but against the specified time rather than the current one.
+ *
+ * @param nowMillis a monotonic time in milliseconds, which must never decrease between calls
+ */
+unsigned int Admission_checkAt(H6N_AdmissionFilter* filter, H6N_IPV6 address, uint64_t nowMillis);
+
+/**
+ * Registers a player with H6AC only if its address is admitted by the filter. Rejected registrations return before
+ * crossing into the H6N agent, so no secret hashing or attestation work is done for them.
+ *
+ * @see H6ACServer::registerPlayer
+ * @return H6N_ADMISSION_ADMITTED if the player was registered, otherwise the same as Admission_check
+ */
+unsigned int Admission_registerPlayer(H6N_AdmissionFilter* filter, H6ACServer* server, H6N_PlayerID playerID,
+	H6N_IPV6 address, const uint8_t* sharedSecret, unsigned int sharedSecretLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_H6NSDK_ADMISSION_H
@@ -42,6 +42,28 @@ extern "C" {
 
 	_H6N_EXPORTED unsigned int _H6N_SPEC Capsule_flattenArgsLength(int argc, char** argv);
 
+	/**
+	* Flattens the arguments in {@code int main(int, char**)} style into a single, space delineated
+	* string in one pass. This is implemented by libh6n itself rather than forwarded to libcapsule, so it
+	* works even when libcapsule cannot be loaded, but isn't available when linking to libcapsule
+	* directly. Unlike {@link Capsule_flattenArgs}, arguments that are empty or contain whitespace or
+	* quotes are quoted, following the Windows command line conventions, so that they survive being
+	* split apart again. The first element in <pre>argv</pre> is ignored, as it normally contains the
+	* path to the executable.
+	*
+	* Nothing is allocated; the string is written straight into the caller's arena. If the arena is too
+	* small, the size it needs is still returned, and the arena holds an empty string.
+	*
+	* @param 	   	argc	 	The number of strings passed in by argv.
+	* @param [in] 	argv	 	An array of strings, the arguments to flatten.
+	* @param [out]	arena	 	The buffer to write the flattened args to, or 0 to query its size.
+	* @param 	   	arenaLength	The size of the arena, in bytes.
+	*
+	* @return	The size of the flattened string, including its terminator, in bytes.
+	*/
+
+	unsigned int Capsule_flattenArgsInto(int argc, char** argv, char* arena, unsigned int arenaLength);
+
 	/**
 	* Callback function that receives an error message.
 	*
@@ -67,7 +89,7 @@ extern "C" {
 	 */
 	typedef void(_H6N_SPEC* Capsule_reloadCallback)();
 
-#define H6N_CAPSULE_VERSION 1
+#define H6N_CAPSULE_VERSION 2
 #define H6N_CAPSULE_INTERFACE "H6Capsule"
 
 
@@ -77,8 +99,34 @@ extern "C" {
 		H6NSDK_VIRTUAL(errorCallback, void)(Capsule_errorCallback errorCallback);
 		H6NSDK_VIRTUAL(progressCallback, void)(Capsule_progressCallback progressCallback);
 	} _H6NSDK_IFACE_END(H6Capsule, 1);
-#define H6Capsule H6NSDK_INTERFACE(H6Capsule, 1)
 
+	/**
+	 * Version 2 of `H6Capsule` adds launchv, which takes the arguments as a vector rather than a flattened string,
+	 * so they are handed to the target process without being flattened and parsed again.
+	 */
+	_H6NSDK_IFACE_BEGIN(H6Capsule, 2) {
+		H6NSDK_VIRTUAL(launch, long)(const char* targetProcess, H6N_IntegrationID id, char* args);
+		H6NSDK_VIRTUAL(errorCallback, void)(Capsule_errorCallback errorCallback);
+		H6NSDK_VIRTUAL(progressCallback, void)(Capsule_progressCallback progressCallback);
+
+		/**
+		 * Launches the target process, passing each argument through as is. This is 0 when libcapsule only provides
+		 * version 1 of `H6Capsule`; fall back to launch with the arguments flattened by Capsule_flattenArgsInto.
+		 *
+		 * @param targetProcess the process to launch
+		 * @param id the integration ID
+		 * @param argc the number of strings in argv
+		 * @param argv the arguments in {@code int main(int, char**)} style; the first element is ignored
+		 * @return one of the H6N_CAPSULE_RESULT values
+		 */
+		H6NSDK_VIRTUAL(launchv, long)(const char* targetProcess, H6N_IntegrationID id, int argc, char** argv);
+	} _H6NSDK_IFACE_END(H6Capsule, 2);
+#define H6Capsule H6NSDK_INTERFACE(H6Capsule, 2)
+
+	/**
+	 * Acquires `H6Capsule` from libcapsule. Versions of libcapsule from before launchv only provide version 1, which
+	 * is handed out as version 2 with launchv set to 0, so check launchv before calling it.
+	 */
 	H6Capsule* Capsule_createCapsule();
 
 #ifdef __cplusplus
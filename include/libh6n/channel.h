@@ -0,0 +1,122 @@
+/**
+ * H6N Software Development Kit
+ * Copyright (c) 2019 H6N Technologies, LLC. All rights reserved.
+ *
+ * This file is subject to the terms and conditions as defined in
+ * your H6N Technologies license agreement. THIS IS NOT OPEN-SOURCE
+ * OR FREE SOFTWARE. You MUST have a license to use or redistribute
+ * these files in source or binary form in any way.
+ */
+
+#ifndef _H6NSDK_CHANNEL_H
+#define _H6NSDK_CHANNEL_H
+
+#include <libh6n/common.h>
+#include <libh6n/capsule.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The environment variable through which a launched game finds its launcher's channel
+#define H6N_CHANNEL_ENVIRONMENT "H6N_CAPSULE_CHANNEL"
+
+// Default ring capacity used by Capsule_launchWithChannel, in bytes
+#define H6N_CHANNEL_DEFAULT_CAPACITY 65536
+
+/*
+ * Message types
+ */
+
+// Payload is the H6N_IntegrationID the game was launched with
+#define H6N_CHANNEL_INTEGRATION_ID 1
+
+// Payload is a float on the interval [0, 1], as passed to Capsule_progressCallback
+#define H6N_CHANNEL_PROGRESS 2
+
+// Payload is a null-terminated error message, as passed to Capsule_errorCallback
+#define H6N_CHANNEL_ERROR 3
+
+// Message types from this value upwards are free for games to use
+#define H6N_CHANNEL_USER 0x10000
+
+/*
+ * Read results
+ */
+
+#define H6N_CHANNEL_EMPTY 0
+#define H6N_CHANNEL_READ 1
+#define H6N_CHANNEL_TOO_SMALL -1
+#define H6N_CHANNEL_CORRUPT -2
+
+typedef struct _H6N_Channel H6N_Channel;
+
+/**
+ * Creates a shared memory channel through which a launcher can hand messages to the game it launches, without
+ * serializing them through the command line, the filesystem or sockets. The channel's name is exported through the
+ * H6N_CHANNEL_ENVIRONMENT environment variable, so any process launched afterwards can find it with Channel_open.
+ *
+ * The channel is a single-producer, single-consumer ring: the launcher writes and the game reads.
+ *
+ * @param capacity the ring size in bytes, rounded up to a power of two
+ * @return the new channel, or 0 if the shared memory could not be created
+ */
+H6N_Channel* Channel_create(unsigned int capacity);
+
+/**
+ * Opens the channel created by the launcher of the current process.
+ *
+ * @return the channel, or 0 if the process wasn't launched with a channel or it no longer exists
+ */
+H6N_Channel* Channel_open();
+
+/**
+ * Closes a channel. Once the launcher has closed its end, the channel can no longer be opened.
+ */
+void Channel_close(H6N_Channel* channel);
+
+/**
+ * Appends a message to the channel.
+ *
+ * @param channel the channel to write to
+ * @param type the message type, one of the H6N_CHANNEL_* message types
+ * @param data the message payload
+ * @param length the length of data, in bytes
+ * @return 1 if the message was written, or 0 if there isn't room for it right now
+ */
+int Channel_write(H6N_Channel* channel, unsigned int type, const void* data, unsigned int length);
+
+/**
+ * Takes the next message from the channel.
+ *
+ * @param channel the channel to read from
+ * @param [out] type receives the message type
+ * @param [out] out the buffer to receive the payload
+ * @param [in,out] length the size of out, in bytes, which receives the length of the payload
+ * @return H6N_CHANNEL_READ if a message was read, H6N_CHANNEL_EMPTY if there are no messages, or
+ *         H6N_CHANNEL_TOO_SMALL if out can't hold the next message, in which case length receives the size needed and
+ *         the message is left in the channel, or H6N_CHANNEL_CORRUPT if the channel holds a message that can't be
+ *         valid, in which case nothing more can be read from it
+ */
+int Channel_read(H6N_Channel* channel, unsigned int* type, void* out, unsigned int* length);
+
+/**
+ * Launches a game through H6Capsule with a channel already set up. The integration ID is written to the channel
+ * before launching, and the capsule's progress and error events are forwarded to it as they occur, in addition to
+ * being passed to the specified callbacks.
+ *
+ * This replaces any error and progress callbacks previously set on the capsule. The channel must be kept open until
+ * the game has opened its end.
+ *
+ * @see H6Capsule::launch
+ * @param [out] channel receives the channel, which the caller must close, or 0 if it could not be created
+ * @return the result of H6Capsule::launch, or H6N_CAPSULE_RESULT_FAILURE if the channel could not be created
+ */
+long Capsule_launchWithChannel(H6Capsule* capsule, const char* targetProcess, H6N_IntegrationID id, char* args,
+	Capsule_errorCallback errorCallback, Capsule_progressCallback progressCallback, H6N_Channel** channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_H6NSDK_CHANNEL_H
@@ -22,6 +22,7 @@ extern "C" {
 
 
 #define H6AC_CLIENT_VERSION 1
+#define H6AC_CLIENT_V2_VERSION 2
 #define H6AC_CLIENT_INTERFACE "H6ACClient"
 
 /**
@@ -31,7 +32,8 @@ extern "C" {
  * *have* to upgrade to a newer SDK version to continue using H6AC, you may just miss out on any new features.
  *
  * Interface name defined in H6AC_CLIENT_INTERFACE as "H6ACClient"
- * Current interface version defined in H6AC_CLIENT_VERSION as 1
+ * Current interface version defined in H6AC_CLIENT_VERSION as 1, and in H6AC_CLIENT_V2_VERSION as 2 for session
+ * resumption
  */
 _H6NSDK_IFACE_BEGIN(H6ACClient, 1) {
 
@@ -95,10 +97,66 @@ _H6NSDK_IFACE_BEGIN(H6ACClient, 1) {
 
 
 }_H6NSDK_IFACE_END(H6ACClient, 1);
+
+/**
+ * Version 2 of `H6ACClient` adds session resumption. Its functions are otherwise the same as version 1's. Agents from
+ * before session resumption only provide version 1, so `H6ACClientV2` is acquired separately from `H6ACClient`.
+ */
+_H6NSDK_IFACE_BEGIN(H6ACClient, 2) {
+
+	/**
+	 * As in version 1.
+	 */
+	H6NSDK_VIRTUAL(setPlayerUniqueID, void)(H6N_PlayerID playerID);
+
+	/**
+	 * As in version 1.
+	 */
+	H6NSDK_VIRTUAL(isPlayerIDAquired, int)();
+
+	/**
+	 * As in version 1.
+	 */
+	H6NSDK_VIRTUAL(setSharedSecret, void)(const uint8_t* sharedSecret, unsigned int sharedSecretLen);
+
+	/**
+	 * As in version 1.
+	 */
+	H6NSDK_VIRTUAL(submitClientAttestation, void)(uint8_t* attestation, unsigned int length);
+
+	/**
+	 * As in version 1.
+	 */
+	H6NSDK_VIRTUAL(disconnect, void)();
+
+	/**
+	 * Submits a resumption ticket to the agent, to resume a session with the server that issued it.
+	 * When the game server issues a ticket through H6ACResumption::issueTicket, your game should hand it to the client
+	 * and have the client keep it across disconnects. On reconnecting to the same server, submitting the ticket in
+	 * place of the shared secret and attestation token lets the server resume the session with a single verification,
+	 * while the server calls H6ACResumption::resumePlayer in place of H6ACServer::registerPlayer.
+	 *
+	 * If the server rejects the ticket, the full exchange is required again. This function does not replace
+	 * H6ACClient::setPlayerUniqueID; the player ID must still be known to H6AC.
+	 *
+	 * @param ticket the resumption ticket to submit, of the specified length
+	 * @param length the length of the ticket, in bytes
+	 */
+	H6NSDK_VIRTUAL(submitResumptionTicket, void)(const uint8_t* ticket, unsigned int length);
+
+
+}_H6NSDK_IFACE_END(H6ACClient, 2);
 #define H6ACClient H6NSDK_INTERFACE(H6ACClient, 1)
+#define H6ACClientV2 H6NSDK_INTERFACE(H6ACClient, 2)
 
 H6ACClient* Agent_createClient();
 
+/**
+ * Acquires version 2 of `H6ACClient`. On agents that only provide version 1, this returns
+ * H6N_ERROR_INTERFACE_NOT_FOUND; check with H6N_IS_ERROR and fall back to Agent_createClient, without resumption.
+ */
+H6ACClientV2* Agent_createClientV2();
+
 
 
 
@@ -203,6 +261,166 @@ _H6NSDK_IFACE_BEGIN(H6ACReport, 1) {
 H6ACReport* Agent_createReport();
 
 
+#define H6AC_TRANSFER_VERSION 1
+#define H6AC_TRANSFER_INTERFACE "H6ACTransfer"
+
+/**
+ * `H6ACTransfer` is an interface through which game servers can move a player's verified H6AC state from one server
+ * process to another, such as when a player moves from a lobby to a match hosted by a sibling process. Adopting
+ * exported state skips the full registration handshake in the receiving process.
+ *
+ * The exported state is opaque, bound to the player and only valid for a short time. It is typically shared between
+ * processes on the same host through the registry in `libh6n/registry.h`.
+ *
+ * Interface name defined in H6AC_TRANSFER_INTERFACE as "H6ACTransfer"
+ * Current interface version defined in H6AC_TRANSFER_VERSION as 1
+ */
+_H6NSDK_IFACE_BEGIN(H6ACTransfer, 1) {
+
+	/**
+	 * Exports the verified state of a registered player, such as its shared secret digest and attestation.
+	 *
+	 * @param playerID the player whose state to export
+	 * @param out the buffer to receive the state, or 0 to query its size
+	 * @param outLength the size of out, in bytes
+	 * @return the size of the state in bytes, or 0 if the player isn't registered or hasn't been verified yet
+	 */
+	H6NSDK_VIRTUAL(exportPlayer, unsigned int)(H6N_PlayerID playerID, uint8_t* out, unsigned int outLength);
+
+	/**
+	 * Registers a player from state exported by another process, in place of H6ACServer::registerPlayer.
+	 *
+	 * @param playerID the player to register, which must match the player the state was exported for
+	 * @param state the exported state
+	 * @param length the length of state, in bytes
+	 * @return 1 if the player was registered, or 0 if the state is invalid or has expired, in which case the player
+	 *         must be registered with H6ACServer::registerPlayer instead
+	 */
+	H6NSDK_VIRTUAL(importPlayer, int)(H6N_PlayerID playerID, const uint8_t* state, unsigned int length);
+
+
+} _H6NSDK_IFACE_END(H6ACTransfer, 1);
+#define H6ACTransfer H6NSDK_INTERFACE(H6ACTransfer, 1)
+
+H6ACTransfer* Agent_createTransfer();
+
+
+#define H6AC_TOKEN_POOL_VERSION 1
+#define H6AC_TOKEN_POOL_INTERFACE "H6ACTokenPool"
+
+/**
+ * Attestation token pool counters, as reported by H6ACTokenPool::getMetrics. All counts are since H6ACServer::begin.
+ */
+typedef struct _H6N_TokenPoolMetrics {
+	// Joins that were given a pre-generated token
+	uint64_t hits;
+	// Joins that found the pool empty and had a token generated on the spot
+	uint64_t misses;
+	// Tokens generated ahead of time by H6ACTokenPool::refill
+	uint64_t generated;
+	// Tokens currently waiting in the pool
+	unsigned int available;
+} H6N_TokenPoolMetrics;
+
+/**
+ * `H6ACTokenPool` controls the pool of attestation tokens H6AC generates ahead of time, so that token generation is
+ * kept off the join path. When a player is registered, a pooled token is bound to the player and delivered through
+ * the attestation callback right away; only when the pool is empty is a token generated on the spot.
+ *
+ * The pool is only refilled when the game calls H6ACTokenPool::refill, so refilling never competes with the game's
+ * own work. Typically, refill is called with whatever time is left over at the end of each server tick.
+ *
+ * Interface name defined in H6AC_TOKEN_POOL_INTERFACE as "H6ACTokenPool"
+ * Current interface version defined in H6AC_TOKEN_POOL_VERSION as 1
+ */
+_H6NSDK_IFACE_BEGIN(H6ACTokenPool, 1) {
+
+	/**
+	 * Sets how many tokens to keep in the pool, and how fast to generate them. Set depth to zero to disable pooling,
+	 * in which case every token is generated at join time.
+	 *
+	 * @param depth the number of tokens to keep ready
+	 * @param refillPerSecond the most tokens to generate per second, to bound the CPU time spent on refilling
+	 */
+	H6NSDK_VIRTUAL(configure, void)(unsigned int depth, unsigned int refillPerSecond);
+
+	/**
+	 * Generates tokens until the pool is full, the refill rate is reached or the time budget runs out.
+	 *
+	 * @param budgetMicros the most time to spend generating tokens, in microseconds
+	 * @return the number of tokens generated
+	 */
+	H6NSDK_VIRTUAL(refill, unsigned int)(unsigned int budgetMicros);
+
+	/**
+	 * Retrieves the pool's hit and miss counters.
+	 *
+	 * @param [out] metrics receives the counters
+	 */
+	H6NSDK_VIRTUAL(getMetrics, void)(H6N_TokenPoolMetrics* metrics);
+
+
+} _H6NSDK_IFACE_END(H6ACTokenPool, 1);
+#define H6ACTokenPool H6NSDK_INTERFACE(H6ACTokenPool, 1)
+
+H6ACTokenPool* Agent_createTokenPool();
+
+
+#define H6AC_RESUMPTION_VERSION 1
+#define H6AC_RESUMPTION_INTERFACE "H6ACResumption"
+
+/**
+ * `H6ACResumption` is an interface through which game servers let clients reconnect without the full player ID,
+ * shared secret and attestation exchange, such as after a brief network drop or a map change. The server issues each
+ * verified player a short-lived resumption ticket, which the game hands to the client; on reconnecting, the client
+ * submits the ticket through H6ACClient::submitResumptionTicket and the server verifies it with resumePlayer.
+ *
+ * Tickets are opaque, bound to the player and to the server process that issued them, and expire after the ticket
+ * lifetime. They stay valid across H6ACServer::end and H6ACServer::begin within the same process.
+ *
+ * Interface name defined in H6AC_RESUMPTION_INTERFACE as "H6ACResumption"
+ * Current interface version defined in H6AC_RESUMPTION_VERSION as 1
+ */
+_H6NSDK_IFACE_BEGIN(H6ACResumption, 1) {
+
+	/**
+	 * Sets how long tickets issued from now on stay valid. Set lifetime to zero to stop issuing tickets.
+	 *
+	 * @param lifetimeSeconds the ticket lifetime, in seconds
+	 */
+	H6NSDK_VIRTUAL(setTicketLifetime, void)(unsigned int lifetimeSeconds);
+
+	/**
+	 * Issues a resumption ticket for a registered player. Tickets are typically issued once the player has been
+	 * verified, and reissued before they expire for players that stay connected.
+	 *
+	 * @param playerID the player to issue a ticket to
+	 * @param out the buffer to receive the ticket, or 0 to query its size
+	 * @param outLength the size of out, in bytes
+	 * @return the size of the ticket in bytes, or 0 if the player isn't registered or hasn't been verified yet
+	 */
+	H6NSDK_VIRTUAL(issueTicket, unsigned int)(H6N_PlayerID playerID, uint8_t* out, unsigned int outLength);
+
+	/**
+	 * Registers a reconnecting player from a ticket issued by this server, in place of H6ACServer::registerPlayer.
+	 * A ticket can only be used once.
+	 *
+	 * @param playerID the player to register, which must match the player the ticket was issued to
+	 * @param ticket the ticket presented by the player
+	 * @param length the length of ticket, in bytes
+	 * @return 1 if the player was registered, or 0 if the ticket is invalid, was issued by another server, has
+	 *         expired or was already used, in which case the player must be registered with
+	 *         H6ACServer::registerPlayer instead
+	 */
+	H6NSDK_VIRTUAL(resumePlayer, int)(H6N_PlayerID playerID, const uint8_t* ticket, unsigned int length);
+
+
+} _H6NSDK_IFACE_END(H6ACResumption, 1);
+#define H6ACResumption H6NSDK_INTERFACE(H6ACResumption, 1)
+
+H6ACResumption* Agent_createResumption();
+
+
 #ifdef __cplusplus
 }
 #endif
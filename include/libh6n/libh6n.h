@@ -12,6 +12,10 @@
 #include <libh6n/common.h>
 #include <libh6n/interfaces.h>
 #include <libh6n/capsule.h>
+#include <libh6n/admission.h>
+#include <libh6n/sessions.h>
+#include <libh6n/channel.h>
+#include <libh6n/registry.h>
 
 #ifndef _H6NSDK_LIBH6N_H
 #define _H6NSDK_LIBH6N_H
@@ -23,6 +27,26 @@ extern "C" {
 
 	void H6N_initialize();
 
+	/**
+	 * Begins capturing the calls made through the H6ACServer, H6ACClient, H6ACReport, H6ACTransfer and H6ACResumption
+	 * interfaces, and the callbacks made by H6AC in return, to a compact binary log that can be replayed offline with
+	 * the h6nreplay tool.
+	 *
+	 * Only interfaces acquired after the capture begins are captured. Records are appended to a memory-mapped file
+	 * that is pre-sized to `capacity` bytes; once it is full, further records are dropped. Shared secrets, attestation
+	 * tokens, resumption tickets and transferred player state are not captured, only their lengths.
+	 *
+	 * @param path the file to capture to, which is overwritten
+	 * @param capacity the maximum size of the capture, in bytes
+	 * @return 1 if the capture began, or 0 if a capture is already running or the file could not be created
+	 */
+	int H6N_beginCapture(const char* path, unsigned int capacity);
+
+	/**
+	 * Ends the running capture, if any, and trims the capture file to the records written.
+	 */
+	void H6N_endCapture();
+
 	/**
 	 * Retrieves a pointer to an interface by the specified name-version pair. The libh6n API tries to remain backwards-
 	 * and forwards-compatible, so interfaces are versioned. Libh6n should automatically use the latest version available
@@ -41,6 +65,52 @@ extern "C" {
 	 */
 	_H6N_EXPORTED void* _H6N_SPEC Agent_createInterface(const char* name, int version);
 
+	/**
+	 * Describes a single interface implemented by a module: its name and the highest version of it available.
+	 */
+	typedef struct _H6N_InterfaceInfo {
+		const char* name;
+		int maxVersion;
+	} H6N_InterfaceInfo;
+
+	/**
+	 * A single name-version pair to resolve with Agent_createInterfaces. After the call, `result` holds the interface
+	 * pointer or an error value, exactly as Agent_createInterface would have returned it.
+	 */
+	typedef struct _H6N_InterfaceRequest {
+		const char* name;
+		int version;
+		void* result;
+	} H6N_InterfaceRequest;
+
+	/**
+	 * Enumerates every interface the H6N agent implements, along with the newest version available of each, in a
+	 * single call. Use this instead of probing Agent_createInterface from high versions down to low ones.
+	 *
+	 * If `out` is null or `outCount` is too small, as many entries as fit are written and the total is still returned,
+	 * so the function may be called once with a null buffer to size it. The name strings are owned by the agent and
+	 * remain valid until the agent is released.
+	 *
+	 * This is implemented by libh6n, which asks the agent when it can and otherwise probes the interfaces this SDK
+	 * knows about; the agent itself doesn't export it, so it isn't available when linking to the agent directly.
+	 *
+	 * @param out the array to receive the interface descriptions, or 0
+	 * @param outCount the number of elements available in out
+	 * @return the total number of interfaces available, or -1 if the H6N agent shared library could not be loaded
+	 */
+	int Agent_enumerateInterfaces(H6N_InterfaceInfo* out, int outCount);
+
+	/**
+	 * Resolves an array of name-version pairs in one go. This is equivalent to calling Agent_createInterface for each
+	 * request, but the agent is only locked (and loaded, if necessary) once for the whole batch. Like
+	 * Agent_enumerateInterfaces, this is implemented by libh6n and isn't available when linking to the agent directly.
+	 *
+	 * @param requests the requests to resolve; each request's `result` field is overwritten
+	 * @param count the number of elements in requests
+	 * @return the number of requests that resolved successfully
+	 */
+	int Agent_createInterfaces(H6N_InterfaceRequest* requests, int count);
+
 	_H6N_EXPORTED void* _H6N_SPEC Capsule_createInterface(const char* name, int version);
 
 #ifdef __cplusplus
@@ -0,0 +1,113 @@
+/**
+ * H6N Software Development Kit
+ * Copyright (c) 2019 H6N Technologies, LLC. All rights reserved.
+ *
+ * This file is subject to the terms and conditions as defined in
+ * your H6N Technologies license agreement. THIS IS NOT OPEN-SOURCE
+ * OR FREE SOFTWARE. You MUST have a license to use or redistribute
+ * these files in source or binary form in any way.
+ */
+
+#ifndef _H6NSDK_REGISTRY_H
+#define _H6NSDK_REGISTRY_H
+
+#include <libh6n/common.h>
+#include <libh6n/interfaces.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The largest player state the registry can hold, in bytes
+#define H6N_REGISTRY_STATE_SIZE 256
+
+// The longest registry name, in bytes
+#define H6N_REGISTRY_MAX_NAME 50
+
+typedef struct _H6N_Registry H6N_Registry;
+
+/**
+ * Opens a host-local player registry in shared memory, creating it if no other process has yet. Game server processes
+ * on the same host that open the registry by the same name can hand verified players to each other, so that a player
+ * moving between matches doesn't need a full registration handshake in the new process.
+ *
+ * The registry is a fixed-size, lock-free hash table keyed by player ID; publishing and looking up a player never
+ * blocks on other processes, and a process that dies mid-write can't block the others for longer than it takes them to
+ * notice. Entries expire `ttlMillis` after they are published, after which their slots are reused. Writers are told
+ * apart by process ID, so all processes sharing a registry must be in the same PID namespace.
+ *
+ * @param name the registry name, shared by all processes that should see each other's players, at most
+ *             H6N_REGISTRY_MAX_NAME bytes long
+ * @param capacity the maximum number of live entries, rounded up to a power of two; every process opening the same
+ *                 registry must specify the same capacity
+ * @param ttlMillis how long a published entry stays valid, in milliseconds
+ * @return the registry, or 0 if it could not be opened, was created with a different capacity or the name is too long
+ */
+H6N_Registry* Registry_open(const char* name, unsigned int capacity, unsigned int ttlMillis);
+
+/**
+ * Closes this process' handle to a registry. The registry itself outlives the processes using it.
+ */
+void Registry_close(H6N_Registry* registry);
+
+/**
+ * Removes a registry's name, so that it is freed once every process using it has closed it, and processes opening it
+ * by name afterwards get a fresh, empty registry. Processes that have it open already can keep using it. On Windows,
+ * a registry is freed with its last handle anyway, so this does nothing there.
+ *
+ * @param name the registry name, as passed to Registry_open
+ */
+void Registry_unlink(const char* name);
+
+/**
+ * Publishes a player's state, replacing any state already published for the player.
+ *
+ * @return 1 if the state was published, or 0 if it is too large or the registry is full
+ */
+int Registry_publish(H6N_Registry* registry, H6N_PlayerID playerID, const uint8_t* state, unsigned int length);
+
+/**
+ * Copies out the state published for a player.
+ *
+ * @param out the buffer to receive the state, which should be H6N_REGISTRY_STATE_SIZE bytes
+ * @param outLength the size of out, in bytes
+ * @return the length of the state, or 0 if no unexpired state is published for the player or it doesn't fit in out
+ */
+unsigned int Registry_lookup(H6N_Registry* registry, H6N_PlayerID playerID, uint8_t* out, unsigned int outLength);
+
+/**
+ * Withdraws the state published for a player, if any.
+ */
+void Registry_remove(H6N_Registry* registry, H6N_PlayerID playerID);
+
+/**
+ * Exports a registered player's verified state from H6AC and publishes it, so sibling processes can adopt the player.
+ * Call this once the player has been verified, or when it is about to be handed to another process. The state is
+ * bound to the player's shared secret, and can only be adopted by a caller passing the same secret.
+ *
+ * @see H6ACTransfer::exportPlayer
+ * @param sharedSecret the secret the player was registered with
+ * @param sharedSecretLen the size of sharedSecret, in bytes
+ * @return 1 if the player was published, or 0 if H6AC had no verified state for it or it could not be published
+ */
+int Registry_publishPlayer(H6N_Registry* registry, H6ACTransfer* transfer, H6N_PlayerID playerID,
+	const uint8_t* sharedSecret, unsigned int sharedSecretLen);
+
+/**
+ * Registers a player, adopting the state published for it by a sibling process if there is any, and falling back to
+ * a full H6ACServer::registerPlayer otherwise. State is only adopted if it was published under the same shared secret;
+ * otherwise the player is registered from scratch with the secret given here. Adopted state is withdrawn from the
+ * registry.
+ *
+ * @see H6ACTransfer::importPlayer
+ * @see H6ACServer::registerPlayer
+ * @return 1 if the player's state was adopted, or 0 if the player was registered from scratch
+ */
+int Registry_adoptPlayer(H6N_Registry* registry, H6ACTransfer* transfer, H6ACServer* server, H6N_PlayerID playerID,
+	const uint8_t* sharedSecret, unsigned int sharedSecretLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_H6NSDK_REGISTRY_H
@@ -0,0 +1,123 @@
+/**
+ * H6N Software Development Kit
+ * Copyright (c) 2019 H6N Technologies, LLC. All rights reserved.
+ *
+ * This file is subject to the terms and conditions as defined in
+ * your H6N Technologies license agreement. THIS IS NOT OPEN-SOURCE
+ * OR FREE SOFTWARE. You MUST have a license to use or redistribute
+ * these files in source or binary form in any way.
+ */
+
+#ifndef _H6NSDK_SESSIONS_H
+#define _H6NSDK_SESSIONS_H
+
+#include <libh6n/common.h>
+#include <libh6n/interfaces.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The player was not heard from within the idle timeout
+#define H6N_SESSION_EXPIRED_IDLE 1
+
+// The player's client attestation was not delivered within the attestation timeout
+#define H6N_SESSION_EXPIRED_ATTESTATION 2
+
+/**
+ * Session expiry policy. A timeout of zero disables that kind of expiry. Deadlines are tracked with a granularity of
+ * `resolutionMillis`, so expirations may be delivered up to that much late.
+ */
+typedef struct _H6N_SessionPolicy {
+	unsigned int idleTimeoutMillis;
+	unsigned int attestationTimeoutMillis;
+	unsigned int resolutionMillis;
+} H6N_SessionPolicy;
+
+/**
+ * Called when a player's session expires. By the time this is called, the player has already been unregistered from
+ * H6AC and forgotten by the tracker; it is expected that the game will kick the player.
+ *
+ * @param playerID the player whose session expired
+ * @param reason one of the H6N_SESSION_EXPIRED_* values
+ */
+typedef void(*Session_expiryCallback)(H6N_PlayerID playerID, int reason);
+
+typedef struct _H6N_SessionTracker H6N_SessionTracker;
+
+/**
+ * Creates a session tracker, which registers and unregisters players with H6AC on behalf of the game and expires
+ * sessions that the game has forgotten about. Deadlines are kept in a hierarchical timer wheel, so scheduling,
+ * cancelling and expiring a deadline all take constant time regardless of the number of players.
+ *
+ * The tracker is thread-safe. Its calls into `server`, and expirations, are queued and made with the tracker unlocked,
+ * so H6AC callbacks and the expiry callback may call back into the tracker. They are always made in the order they
+ * were queued, so an expired session's unregistration is ordered with the player registering again. While another
+ * thread is making queued calls, or when called back from one of them, a tracker function returns once its calls are
+ * queued, and they are made shortly after by that thread.
+ *
+ * @param server the server interface to register players with, or 0 to only track deadlines
+ * @param policy the policy to apply, which is copied
+ * @return the new tracker, or 0 if the policy's resolution is zero
+ */
+H6N_SessionTracker* Session_createTracker(H6ACServer* server, const H6N_SessionPolicy* policy);
+
+/**
+ * Frees a tracker created by Session_createTracker. Players still being tracked are not unregistered.
+ */
+void Session_freeTracker(H6N_SessionTracker* tracker);
+
+/**
+ * Sets the callback that receives session expirations.
+ */
+void Session_setExpiryCallback(H6N_SessionTracker* tracker, Session_expiryCallback callback);
+
+/**
+ * Registers a player with H6AC and starts its idle and attestation deadlines. Registering a player that is already
+ * tracked restarts both deadlines.
+ *
+ * @see H6ACServer::registerPlayer
+ */
+void Session_registerPlayer(H6N_SessionTracker* tracker, H6N_PlayerID playerID, const uint8_t* sharedSecret,
+	unsigned int sharedSecretLen);
+
+/**
+ * Unregisters a player from H6AC and stops tracking it.
+ *
+ * @see H6ACServer::unregisterPlayer
+ */
+void Session_unregisterPlayer(H6N_SessionTracker* tracker, H6N_PlayerID playerID);
+
+/**
+ * Restarts the player's idle deadline. Call this whenever the game hears from the player.
+ */
+void Session_touch(H6N_SessionTracker* tracker, H6N_PlayerID playerID);
+
+/**
+ * Cancels the player's attestation deadline. Call this once the player's client has submitted its attestation.
+ */
+void Session_attested(H6N_SessionTracker* tracker, H6N_PlayerID playerID);
+
+/**
+ * Advances the tracker to the current time and delivers any expirations to the expiry callback. This is typically
+ * called once per server tick.
+ *
+ * @return the number of sessions that expired
+ */
+unsigned int Session_update(H6N_SessionTracker* tracker);
+
+/**
+ * Same as Session_update, but advances the tracker to the specified time. Once this has been called, the tracker
+ * follows the caller's clock rather than the monotonic clock, and only knows that clock's time as of the most recent
+ * update; deadlines started after that are measured from the time of that update, so they may expire early by as
+ * much as the time since. Call this before registering players, and often, when driving a tracker with it.
+ *
+ * @param elapsedMillis the time since the tracker was created, in milliseconds, which must never decrease
+ */
+unsigned int Session_updateAt(H6N_SessionTracker* tracker, uint64_t elapsedMillis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //_H6NSDK_SESSIONS_H
@@ -0,0 +1,319 @@
+#include "libh6n/admission.h"
+#include "platform.h"
+
+#include <string.h>
+#include <vector>
+
+
+/*
+ * Per-subnet token buckets, indexed by a crit-bit tree over the masked 128-bit subnet prefix.
+ *
+ * The tree has exactly one internal node per tracked subnet (less one), and lookups only test
+ * the bits where tracked subnets differ, so a lookup is at most 128 bit tests and one compare.
+ * Storage for both node kinds, and the scratch space pruning rebuilds the tree from, is reserved
+ * up front from maxSubnets, so a join storm never allocates.
+ *
+ * Subnets that don't fit in the tree are hashed onto a fixed set of overflow buckets, so one busy
+ * untracked network only drains the overflow bucket it shares with a few others.
+ *
+ * The clock is whatever the caller passes to Admission_checkAt, so the overflow buckets and the
+ * prune timer are only started on the first check.
+ */
+
+// Child indices with this bit set refer to leaves rather than internal nodes
+#define LEAF_FLAG 0x80000000u
+
+// Bucket contents are kept in thousandths of a token so refill needs no division
+#define TOKEN_SCALE 1000
+
+// Don't rebuild the tree to prune idle subnets more than once per interval
+#define PRUNE_INTERVAL_MILLIS 1000
+
+// Number of buckets shared by subnets that can't be tracked individually
+#define OVERFLOW_BUCKETS 64
+
+typedef struct {
+	uint64_t tokens;
+	uint64_t lastRefill;
+} Bucket;
+
+typedef struct {
+	H6N_IPV6 prefix;
+	Bucket bucket;
+} SubnetLeaf;
+
+typedef struct {
+	uint32_t child[2];
+	uint8_t bit;
+} SubnetNode;
+
+struct _H6N_AdmissionFilter {
+	H6N_AdmissionPolicy policy;
+	PlatformMutex mutex;
+
+	std::vector<SubnetNode> nodes;
+	std::vector<SubnetLeaf> leaves;
+	std::vector<SubnetLeaf> scratch;
+	uint32_t root;
+
+	bool started;
+	Bucket overflow[OVERFLOW_BUCKETS];
+	uint64_t lastPrune;
+};
+
+
+static bool IsIPV4Mapped(const H6N_IPV6& address) {
+	static const uint8_t mappedPrefix[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF };
+	return memcmp(address.bytes, mappedPrefix, sizeof(mappedPrefix)) == 0;
+}
+
+static H6N_IPV6 MaskPrefix(const H6N_AdmissionPolicy& policy, H6N_IPV6 address) {
+	unsigned int length = IsIPV4Mapped(address) ? 96 + policy.ipv4PrefixLength : policy.ipv6PrefixLength;
+
+	for (unsigned int i = 0; i < 16; i++) {
+		if (length >= 8) {
+			length -= 8;
+		} else {
+			address.bytes[i] &= (uint8_t)(0xFF00 >> length);
+			length = 0;
+		}
+	}
+
+	return address;
+}
+
+static int PrefixBit(const H6N_IPV6& prefix, unsigned int bit) {
+	return (prefix.bytes[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+// Returns the first bit at which a and b differ, or -1 if they are equal
+static int CriticalBit(const H6N_IPV6& a, const H6N_IPV6& b) {
+	for (unsigned int i = 0; i < 16; i++) {
+		uint8_t diff = a.bytes[i] ^ b.bytes[i];
+		if (diff == 0)
+			continue;
+
+		int bit = 0;
+		while ((diff & 0x80) == 0) {
+			diff <<= 1;
+			bit++;
+		}
+		return (int)(i * 8) + bit;
+	}
+	return -1;
+}
+
+// FNV-1a over the masked prefix
+static Bucket* OverflowBucket(H6N_AdmissionFilter* filter, const H6N_IPV6& prefix) {
+	uint32_t hash = 2166136261u;
+	for (unsigned int i = 0; i < 16; i++)
+		hash = (hash ^ prefix.bytes[i]) * 16777619u;
+
+	return &filter->overflow[hash % OVERFLOW_BUCKETS];
+}
+
+static SubnetLeaf* FindLeaf(H6N_AdmissionFilter* filter, const H6N_IPV6& prefix) {
+	if (filter->leaves.empty())
+		return 0;
+
+	uint32_t index = filter->root;
+	while ((index & LEAF_FLAG) == 0) {
+		const SubnetNode& node = filter->nodes[index];
+		index = node.child[PrefixBit(prefix, node.bit)];
+	}
+
+	return &filter->leaves[index & ~LEAF_FLAG];
+}
+
+// The prefix must not already be in the tree, and there must be room for another leaf
+static SubnetLeaf* InsertLeaf(H6N_AdmissionFilter* filter, const H6N_IPV6& prefix, int critBit) {
+	uint32_t leafIndex = (uint32_t)filter->leaves.size() | LEAF_FLAG;
+	filter->leaves.push_back(SubnetLeaf());
+	filter->leaves.back().prefix = prefix;
+
+	if (leafIndex == LEAF_FLAG) {
+		filter->root = leafIndex;
+		return &filter->leaves.back();
+	}
+
+	// Walk down to the edge the new internal node splits
+	uint32_t* slot = &filter->root;
+	while ((*slot & LEAF_FLAG) == 0) {
+		SubnetNode& node = filter->nodes[*slot];
+		if (node.bit > critBit)
+			break;
+		slot = &node.child[PrefixBit(prefix, node.bit)];
+	}
+
+	SubnetNode split;
+	split.bit = (uint8_t)critBit;
+	split.child[PrefixBit(prefix, critBit)] = leafIndex;
+	split.child[!PrefixBit(prefix, critBit)] = *slot;
+
+	// Capacity was reserved up front, so this never invalidates slot
+	filter->nodes.push_back(split);
+	*slot = (uint32_t)filter->nodes.size() - 1;
+
+	return &filter->leaves.back();
+}
+
+static void Refill(const H6N_AdmissionPolicy& policy, Bucket& bucket, uint64_t now) {
+	uint64_t capacity = (uint64_t)policy.burst * TOKEN_SCALE;
+
+	if (now > bucket.lastRefill) {
+		bucket.tokens += (now - bucket.lastRefill) * policy.refillPerSecond;
+		if (bucket.tokens > capacity)
+			bucket.tokens = capacity;
+	}
+	bucket.lastRefill = now;
+}
+
+static unsigned int TakeToken(const H6N_AdmissionPolicy& policy, Bucket& bucket, uint64_t now) {
+	Refill(policy, bucket, now);
+
+	if (bucket.tokens >= TOKEN_SCALE) {
+		bucket.tokens -= TOKEN_SCALE;
+		return H6N_ADMISSION_ADMITTED;
+	}
+
+	if (policy.refillPerSecond == 0)
+		return H6N_ADMISSION_NEVER;
+
+	uint64_t missing = TOKEN_SCALE - bucket.tokens;
+	return (unsigned int)((missing + policy.refillPerSecond - 1) / policy.refillPerSecond);
+}
+
+// Drops subnets whose buckets have refilled completely, as they are indistinguishable from new ones
+static void PruneIdleSubnets(H6N_AdmissionFilter* filter, uint64_t now) {
+	std::vector<SubnetLeaf>& active = filter->scratch;
+	active.clear();
+
+	for (SubnetLeaf& leaf : filter->leaves) {
+		Refill(filter->policy, leaf.bucket, now);
+		if (leaf.bucket.tokens < (uint64_t)filter->policy.burst * TOKEN_SCALE)
+			active.push_back(leaf);
+	}
+
+	filter->leaves.clear();
+	filter->nodes.clear();
+
+	for (const SubnetLeaf& leaf : active) {
+		SubnetLeaf* best = FindLeaf(filter, leaf.prefix);
+		int critBit = best != 0 ? CriticalBit(leaf.prefix, best->prefix) : 0;
+		InsertLeaf(filter, leaf.prefix, critBit)->bucket = leaf.bucket;
+	}
+
+	filter->lastPrune = now;
+}
+
+static Bucket* FindBucket(H6N_AdmissionFilter* filter, const H6N_IPV6& prefix, uint64_t now) {
+	SubnetLeaf* best = FindLeaf(filter, prefix);
+	int critBit = 0;
+
+	if (best != 0) {
+		critBit = CriticalBit(prefix, best->prefix);
+		if (critBit < 0)
+			return &best->bucket;
+	}
+
+	if (filter->leaves.size() >= filter->policy.maxSubnets) {
+		if (now < filter->lastPrune + PRUNE_INTERVAL_MILLIS)
+			return OverflowBucket(filter, prefix);
+
+		PruneIdleSubnets(filter, now);
+		if (filter->leaves.size() >= filter->policy.maxSubnets)
+			return OverflowBucket(filter, prefix);
+
+		// The tree was rebuilt, so the closest leaf may have changed
+		best = FindLeaf(filter, prefix);
+		critBit = best != 0 ? CriticalBit(prefix, best->prefix) : 0;
+	}
+
+	SubnetLeaf* leaf = InsertLeaf(filter, prefix, critBit);
+	leaf->bucket.tokens = (uint64_t)filter->policy.burst * TOKEN_SCALE;
+	leaf->bucket.lastRefill = now;
+	return &leaf->bucket;
+}
+
+
+/*
+ * Exported function implementation
+ */
+
+extern "C" {
+
+	H6N_AdmissionFilter* Admission_createFilter(const H6N_AdmissionPolicy* policy) {
+		if (policy == 0
+			|| policy->ipv4PrefixLength > 32
+			|| policy->ipv6PrefixLength > 128
+			|| policy->burst == 0
+			|| policy->maxSubnets == 0
+			|| policy->maxSubnets >= LEAF_FLAG)
+			return 0;
+
+		H6N_AdmissionFilter* filter = new H6N_AdmissionFilter();
+		filter->policy = *policy;
+		filter->nodes.reserve(policy->maxSubnets);
+		filter->leaves.reserve(policy->maxSubnets);
+		filter->scratch.reserve(policy->maxSubnets);
+		filter->root = 0;
+		filter->started = false;
+		Platform_initMutex(&filter->mutex);
+		return filter;
+	}
+
+	void Admission_freeFilter(H6N_AdmissionFilter* filter) {
+		if (filter == 0)
+			return;
+
+		Platform_freeMutex(&filter->mutex);
+		delete filter;
+	}
+
+	H6N_IPV6 Admission_ipv4(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+		H6N_IPV6 address;
+		memset(&address, 0, sizeof(address));
+		address.bytes[10] = 0xFF;
+		address.bytes[11] = 0xFF;
+		address.bytes[12] = a;
+		address.bytes[13] = b;
+		address.bytes[14] = c;
+		address.bytes[15] = d;
+		return address;
+	}
+
+	unsigned int Admission_checkAt(H6N_AdmissionFilter* filter, H6N_IPV6 address, uint64_t nowMillis) {
+		H6N_IPV6 prefix = MaskPrefix(filter->policy, address);
+
+		Platform_enterMutex(&filter->mutex);
+
+		if (!filter->started) {
+			for (Bucket& bucket : filter->overflow) {
+				bucket.tokens = (uint64_t)filter->policy.burst * TOKEN_SCALE;
+				bucket.lastRefill = nowMillis;
+			}
+			filter->lastPrune = nowMillis;
+			filter->started = true;
+		}
+
+		unsigned int result = TakeToken(filter->policy, *FindBucket(filter, prefix, nowMillis), nowMillis);
+		Platform_leaveMutex(&filter->mutex);
+
+		return result;
+	}
+
+	unsigned int Admission_check(H6N_AdmissionFilter* filter, H6N_IPV6 address) {
+		return Admission_checkAt(filter, address, Platform_tickMillis());
+	}
+
+	unsigned int Admission_registerPlayer(H6N_AdmissionFilter* filter, H6ACServer* server, H6N_PlayerID playerID,
+		H6N_IPV6 address, const uint8_t* sharedSecret, unsigned int sharedSecretLen) {
+		unsigned int result = Admission_check(filter, address);
+		if (result != H6N_ADMISSION_ADMITTED)
+			return result;
+
+		server->registerPlayer(playerID, sharedSecret, sharedSecretLen);
+		return H6N_ADMISSION_ADMITTED;
+	}
+
+}
@@ -0,0 +1,172 @@
+#include "libh6n/capsule.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SANITIZE_ADDRESS__)
+#  define H6N_ADDRESS_SANITIZER
+#elif defined(__has_feature)
+#  if __has_feature(address_sanitizer)
+#    define H6N_ADDRESS_SANITIZER
+#  endif
+#endif
+
+// The vector scan reads whole blocks past the end of each argument, which AddressSanitizer reports
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(H6N_ADDRESS_SANITIZER)
+#  define H6N_FLATTEN_SSE2
+#  include <emmintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  endif
+#endif
+
+
+/*
+ * Argument flattening
+ *
+ * Each argument is scanned once to find both its length and whether it needs quoting, and is
+ * then copied straight into the arena. Plain arguments, which are the vast majority, are copied
+ * whole; only arguments that need quoting are copied byte by byte.
+ *
+ * Quoting follows the Windows command line conventions: the argument is wrapped in quotes,
+ * quotes inside it are escaped with a backslash, and backslashes are doubled where they precede
+ * a quote, including the closing one.
+ */
+
+typedef struct {
+	char* out;
+	size_t length;
+	size_t used;
+} Arena;
+
+#ifdef H6N_FLATTEN_SSE2
+
+static unsigned int CountTrailingZeros(unsigned int mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+// Scans 16 bytes at a time. Loads are aligned, so they never cross into a page the string doesn't touch.
+static size_t ScanArg(const char* arg, bool& quote) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	const __m128i newline = _mm_set1_epi8('\n');
+	const __m128i vtab = _mm_set1_epi8('\v');
+	const __m128i dquote = _mm_set1_epi8('"');
+
+	size_t misalignment = (uintptr_t)arg & 15;
+	const char* block = arg - misalignment;
+	unsigned int valid = 0xFFFFu << misalignment;
+	unsigned int special = 0;
+
+	for (;;) {
+		__m128i bytes = _mm_load_si128((const __m128i*)block);
+		unsigned int end = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)) & valid;
+		__m128i matches = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_cmpeq_epi8(bytes, tab)),
+			_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, newline), _mm_cmpeq_epi8(bytes, vtab)),
+				_mm_cmpeq_epi8(bytes, dquote)));
+		unsigned int found = (unsigned int)_mm_movemask_epi8(matches) & valid;
+
+		if (end != 0) {
+			unsigned int terminator = CountTrailingZeros(end);
+			special |= found & ((1u << terminator) - 1);
+			quote = special != 0;
+			return (size_t)(block - arg) + terminator;
+		}
+
+		special |= found;
+		valid = 0xFFFFu;
+		block += 16;
+	}
+}
+
+#else
+
+static bool NeedsQuoting(char c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '"';
+}
+
+static size_t ScanArg(const char* arg, bool& quote) {
+	const char* end = arg;
+	quote = false;
+	for (; *end != 0; end++)
+		quote |= NeedsQuoting(*end);
+	return (size_t)(end - arg);
+}
+
+#endif
+
+static void Put(Arena& arena, char c) {
+	if (arena.used < arena.length)
+		arena.out[arena.used] = c;
+	arena.used++;
+}
+
+static void PutRepeated(Arena& arena, char c, size_t count) {
+	while (count-- != 0)
+		Put(arena, c);
+}
+
+static void PutQuoted(Arena& arena, const char* arg, size_t length) {
+	size_t backslashes = 0;
+
+	Put(arena, '"');
+	for (size_t i = 0; i < length; i++) {
+		if (arg[i] == '"') {
+			PutRepeated(arena, '\\', backslashes + 1);
+			backslashes = 0;
+		}
+		else if (arg[i] == '\\')
+			backslashes++;
+		else
+			backslashes = 0;
+
+		Put(arena, arg[i]);
+	}
+	PutRepeated(arena, '\\', backslashes);
+	Put(arena, '"');
+}
+
+
+/*
+ * Exported function implementation
+ */
+
+extern "C" {
+
+	unsigned int Capsule_flattenArgsInto(int argc, char** argv, char* arena, unsigned int arenaLength) {
+		Arena out = { arena, arena != 0 ? arenaLength : 0, 0 };
+
+		for (int i = 1; i < argc; i++) {
+			if (i > 1)
+				Put(out, ' ');
+
+			bool quote;
+			size_t length = ScanArg(argv[i], quote);
+
+			if (quote || length == 0)
+				PutQuoted(out, argv[i], length);
+			else {
+				if (out.used + length <= out.length)
+					memcpy(out.out + out.used, argv[i], length);
+				out.used += length;
+			}
+		}
+		Put(out, 0);
+
+		// Never leave a partial string behind
+		if (out.used > out.length && out.length != 0)
+			out.out[0] = 0;
+
+		return (unsigned int)out.used;
+	}
+
+}
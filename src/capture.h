@@ -0,0 +1,74 @@
+/*
+ * Call capture format
+ *
+ * A capture file starts with a CaptureHeader, followed by CaptureRecords. Each record is
+ * followed by `length` bytes of payload, padded so the next record is CAPTURE_ALIGN aligned.
+ * The file is pre-sized and zero-filled while capturing, so readers stop at the first record
+ * with a type of CAPTURE_NONE.
+ *
+ * Shared secrets, attestation tokens, resumption tickets and transferred player state are never written to a
+ * capture; only their lengths are, as that is all that's needed to reproduce the cost of handling them. Calls whose
+ * outcome depends on that data, such as importing state or resuming from a ticket, can't be reproduced from the
+ * lengths alone, so they are recorded once they return, along with their result.
+ */
+
+#ifndef _H6NSDK_CAPTURE_H
+#define _H6NSDK_CAPTURE_H
+
+#include <stdint.h>
+
+#define CAPTURE_MAGIC 0x50433648u // "H6CP"
+#define CAPTURE_VERSION 2
+#define CAPTURE_ALIGN 8
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t reserved;
+} CaptureHeader;
+
+typedef struct {
+	// Time since the capture began
+	uint64_t timeMicros;
+	uint16_t type;
+	uint16_t length;
+	uint32_t reserved;
+} CaptureRecord;
+
+/*
+ * Record types and their payloads
+ */
+
+#define CAPTURE_NONE 0
+
+// H6ACServer calls
+#define CAPTURE_SERVER_BEGIN 1              // H6N_IntegrationID
+#define CAPTURE_SERVER_END 2                // (none)
+#define CAPTURE_SERVER_REGISTER 3           // H6N_PlayerID, uint32_t secret length
+#define CAPTURE_SERVER_UNREGISTER 4         // H6N_PlayerID
+
+// H6ACClient calls
+#define CAPTURE_CLIENT_PLAYER_ID 16         // H6N_PlayerID
+#define CAPTURE_CLIENT_SECRET 17            // uint32_t secret length
+#define CAPTURE_CLIENT_ATTESTATION 18       // uint32_t attestation length
+#define CAPTURE_CLIENT_DISCONNECT 19        // (none)
+#define CAPTURE_CLIENT_RESUME 20            // uint32_t ticket length
+
+// H6ACReport calls
+#define CAPTURE_REPORT_PLAYER 32            // H6N_PlayerID, int32_t reserved
+
+// H6ACTransfer calls
+#define CAPTURE_TRANSFER_EXPORT 36          // H6N_PlayerID, uint32_t buffer length
+#define CAPTURE_TRANSFER_IMPORT 37          // H6N_PlayerID, uint32_t state length, int32_t result
+
+// H6ACResumption calls
+#define CAPTURE_RESUMPTION_LIFETIME 40      // uint32_t lifetime in seconds
+#define CAPTURE_RESUMPTION_ISSUE 41         // H6N_PlayerID, uint32_t buffer length
+#define CAPTURE_RESUMPTION_RESUME 42        // H6N_PlayerID, uint32_t ticket length, int32_t result
+
+// Callbacks from the agent
+#define CAPTURE_CALLBACK_KICK 48            // H6N_PlayerID, reason string
+#define CAPTURE_CALLBACK_ATTESTATION 49     // H6N_PlayerID, uint32_t attestation length
+#define CAPTURE_CALLBACK_UPDATE 50          // (none)
+
+#endif //_H6NSDK_CAPTURE_H
@@ -0,0 +1,270 @@
+#include "libh6n/channel.h"
+#include "platform.h"
+
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+
+
+/*
+ * Shared memory ring
+ *
+ * The region starts with a header, followed by the ring itself. Each message is a MessageHeader
+ * followed by its payload, padded to MESSAGE_ALIGN bytes, and may wrap around the end of the
+ * ring. The head and tail are free-running byte counters on separate cache lines; only the
+ * writer moves the head and only the reader moves the tail, so no locking is needed across the
+ * two processes. Writers within the launcher process are serialized with a local mutex, as the
+ * capsule may report progress from its own threads.
+ */
+
+#define CHANNEL_MAGIC 0x4E433648u // "H6CN"
+#define CHANNEL_VERSION 1
+
+#define CACHE_LINE 64
+#define MESSAGE_ALIGN 8
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t capacity;
+	alignas(CACHE_LINE) std::atomic<uint64_t> head;
+	alignas(CACHE_LINE) std::atomic<uint64_t> tail;
+} ChannelHeader;
+
+typedef struct {
+	uint32_t type;
+	uint32_t length;
+} MessageHeader;
+
+#define RING_OFFSET ((sizeof(ChannelHeader) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1))
+
+struct _H6N_Channel {
+	PlatformSharedMemory memory;
+	PlatformMutex writeMutex;
+	ChannelHeader* header;
+	uint8_t* ring;
+	uint32_t mask;
+};
+
+
+static uint32_t MessageSize(uint32_t length) {
+	return (uint32_t)sizeof(MessageHeader) + ((length + MESSAGE_ALIGN - 1) & ~(uint32_t)(MESSAGE_ALIGN - 1));
+}
+
+static void CopyIn(H6N_Channel* channel, uint64_t position, const void* data, uint32_t length) {
+	uint32_t offset = (uint32_t)position & channel->mask;
+	uint32_t first = channel->mask + 1 - offset;
+	if (first > length)
+		first = length;
+
+	memcpy(channel->ring + offset, data, first);
+	memcpy(channel->ring, (const uint8_t*)data + first, length - first);
+}
+
+static void CopyOut(H6N_Channel* channel, uint64_t position, void* out, uint32_t length) {
+	uint32_t offset = (uint32_t)position & channel->mask;
+	uint32_t first = channel->mask + 1 - offset;
+	if (first > length)
+		first = length;
+
+	memcpy(out, channel->ring + offset, first);
+	memcpy((uint8_t*)out + first, channel->ring, length - first);
+}
+
+static H6N_Channel* AttachChannel(const PlatformSharedMemory& memory) {
+	H6N_Channel* channel = new H6N_Channel();
+	channel->memory = memory;
+	channel->header = (ChannelHeader*)memory.base;
+	channel->ring = (uint8_t*)memory.base + RING_OFFSET;
+	channel->mask = channel->header->capacity - 1;
+	Platform_initMutex(&channel->writeMutex);
+	return channel;
+}
+
+
+/*
+ * Launch helpers
+ *
+ * Capsule callbacks carry no context, so the channel being launched with is kept globally. The
+ * capsule may call back from its own threads at any time, so forwarders count themselves in
+ * while they use the channel, and Channel_close waits for them to leave before freeing it.
+ */
+
+static std::atomic<H6N_Channel*> LaunchChannel(nullptr);
+static std::atomic<Capsule_errorCallback> LaunchErrorCallback(nullptr);
+static std::atomic<Capsule_progressCallback> LaunchProgressCallback(nullptr);
+static std::atomic<unsigned int> LaunchForwarders(0);
+
+static void ForwardToChannel(unsigned int type, const void* data, unsigned int length) {
+	LaunchForwarders++;
+	H6N_Channel* channel = LaunchChannel;
+	if (channel != 0)
+		Channel_write(channel, type, data, length);
+	LaunchForwarders--;
+}
+
+static void ForwardError(const char* message) {
+	ForwardToChannel(H6N_CHANNEL_ERROR, message, (unsigned int)strlen(message) + 1);
+
+	Capsule_errorCallback callback = LaunchErrorCallback;
+	if (callback != 0)
+		callback(message);
+}
+
+static void ForwardProgress(float percent) {
+	ForwardToChannel(H6N_CHANNEL_PROGRESS, &percent, sizeof(percent));
+
+	Capsule_progressCallback callback = LaunchProgressCallback;
+	if (callback != 0)
+		callback(percent);
+}
+
+
+/*
+ * Exported function implementation
+ */
+
+extern "C" {
+
+	H6N_Channel* Channel_create(unsigned int capacity) {
+		static std::atomic<unsigned int> counter(0);
+
+		uint32_t ringSize = MESSAGE_ALIGN * 2;
+		while (ringSize < capacity && ringSize < 0x80000000u)
+			ringSize <<= 1;
+
+		char name[sizeof(((PlatformSharedMemory*)0)->name)];
+		snprintf(name, sizeof(name), "h6n-channel-%lu-%u", Platform_processID(), counter++);
+
+		PlatformSharedMemory memory;
+		if (!Platform_createSharedMemory(&memory, name, RING_OFFSET + ringSize))
+			return 0;
+
+		ChannelHeader* header = new (memory.base) ChannelHeader();
+		header->magic = CHANNEL_MAGIC;
+		header->version = CHANNEL_VERSION;
+		header->capacity = ringSize;
+
+		Platform_setEnvironment(H6N_CHANNEL_ENVIRONMENT, name);
+		return AttachChannel(memory);
+	}
+
+	H6N_Channel* Channel_open() {
+		char name[sizeof(((PlatformSharedMemory*)0)->name)];
+		if (!Platform_getEnvironment(H6N_CHANNEL_ENVIRONMENT, name, sizeof(name)))
+			return 0;
+
+		// Map the header first to learn how big the ring is
+		PlatformSharedMemory memory;
+		if (!Platform_openSharedMemory(&memory, name, RING_OFFSET, 0))
+			return 0;
+
+		ChannelHeader* header = (ChannelHeader*)memory.base;
+		uint32_t capacity = header->capacity;
+		bool valid = header->magic == CHANNEL_MAGIC && header->version == CHANNEL_VERSION
+			&& capacity != 0 && (capacity & (capacity - 1)) == 0;
+		Platform_freeSharedMemory(&memory);
+
+		if (!valid || !Platform_openSharedMemory(&memory, name, RING_OFFSET + capacity, 0))
+			return 0;
+
+		return AttachChannel(memory);
+	}
+
+	void Channel_close(H6N_Channel* channel) {
+		if (channel == 0)
+			return;
+
+		// Stop forwarding capsule callbacks, and wait out any that are writing to the channel right now
+		H6N_Channel* expected = channel;
+		if (LaunchChannel.compare_exchange_strong(expected, nullptr)) {
+			while (LaunchForwarders != 0)
+				Platform_sleepMicros(0);
+		}
+
+		// Processes launched from now on must not find a channel that's gone
+		char name[sizeof(channel->memory.name)];
+		if (channel->memory.owner
+			&& Platform_getEnvironment(H6N_CHANNEL_ENVIRONMENT, name, sizeof(name))
+			&& strcmp(name, channel->memory.name) == 0)
+			Platform_setEnvironment(H6N_CHANNEL_ENVIRONMENT, 0);
+
+		Platform_freeSharedMemory(&channel->memory);
+		Platform_freeMutex(&channel->writeMutex);
+		delete channel;
+	}
+
+	int Channel_write(H6N_Channel* channel, unsigned int type, const void* data, unsigned int length) {
+		uint32_t size = MessageSize(length);
+		if (length > channel->mask || size > channel->mask + 1)
+			return 0;
+
+		Platform_enterMutex(&channel->writeMutex);
+
+		uint64_t head = channel->header->head.load(std::memory_order_relaxed);
+		uint64_t tail = channel->header->tail.load(std::memory_order_acquire);
+		if (head + size - tail > channel->mask + 1) {
+			Platform_leaveMutex(&channel->writeMutex);
+			return 0;
+		}
+
+		MessageHeader message;
+		message.type = type;
+		message.length = length;
+		CopyIn(channel, head, &message, sizeof(message));
+		CopyIn(channel, head + sizeof(message), data, length);
+
+		channel->header->head.store(head + size, std::memory_order_release);
+
+		Platform_leaveMutex(&channel->writeMutex);
+		return 1;
+	}
+
+	int Channel_read(H6N_Channel* channel, unsigned int* type, void* out, unsigned int* length) {
+		uint64_t tail = channel->header->tail.load(std::memory_order_relaxed);
+		uint64_t head = channel->header->head.load(std::memory_order_acquire);
+		if (head == tail)
+			return H6N_CHANNEL_EMPTY;
+
+		// The ring is shared with another process, so nothing read from it is trusted to stay within it
+		uint64_t available = head - tail;
+		if (available < sizeof(MessageHeader) || available > (uint64_t)channel->mask + 1)
+			return H6N_CHANNEL_CORRUPT;
+
+		MessageHeader message;
+		CopyOut(channel, tail, &message, sizeof(message));
+		if (message.length > channel->mask + 1 - sizeof(MessageHeader) || MessageSize(message.length) > available)
+			return H6N_CHANNEL_CORRUPT;
+
+		if (message.length > *length) {
+			*length = message.length;
+			return H6N_CHANNEL_TOO_SMALL;
+		}
+
+		CopyOut(channel, tail + sizeof(message), out, message.length);
+		*type = message.type;
+		*length = message.length;
+
+		channel->header->tail.store(tail + MessageSize(message.length), std::memory_order_release);
+		return H6N_CHANNEL_READ;
+	}
+
+	long Capsule_launchWithChannel(H6Capsule* capsule, const char* targetProcess, H6N_IntegrationID id, char* args,
+		Capsule_errorCallback errorCallback, Capsule_progressCallback progressCallback, H6N_Channel** channel) {
+		*channel = Channel_create(H6N_CHANNEL_DEFAULT_CAPACITY);
+		if (*channel == 0)
+			return H6N_CAPSULE_RESULT_FAILURE;
+
+		Channel_write(*channel, H6N_CHANNEL_INTEGRATION_ID, &id, sizeof(id));
+
+		LaunchChannel = *channel;
+		LaunchErrorCallback = errorCallback;
+		LaunchProgressCallback = progressCallback;
+		capsule->errorCallback(ForwardError);
+		capsule->progressCallback(ForwardProgress);
+
+		return capsule->launch(targetProcess, id, args);
+	}
+
+}
@@ -1,34 +1,12 @@
 #include "libh6n/interfaces.h"
 #include "libh6n/libh6n.h"
+#include "capture.h"
+#include "platform.h"
 
-
-/*
- * Platform layer
- *
- * While H6NSDK is internally built inside the monorepo source tree, this library may need to
- * be built by customers in a shared-source agreement. As such, we cannot use the platform
- * abstraction layer in libagent and must re-implement platform-dependent units in here.
- */
-
-
-#if defined(_WIN32)
-#include <Windows.h>
-typedef CRITICAL_SECTION PlatformMutex;
-#elif defined(__linux__) || defined(__APPLE__)
-#include <pthread.h>
-typedef pthread_mutex_t PlatformMutex;
-#define _H6N_POSIX
-#endif
+#include <atomic>
+#include <string.h>
 
 
-void Platform_initMutex(PlatformMutex* mutex);
-void Platform_enterMutex(PlatformMutex* mutex);
-void Platform_leaveMutex(PlatformMutex* mutex);
-
-void* Platform_acquireModule(const char* moduleName);
-void Platform_freeModule(void* handle);
-void* Platform_moduleSymbol(void* handle, const char* symbolName);
-
 /*
  * Global state
  */
@@ -36,6 +14,8 @@ void* Platform_moduleSymbol(void* handle, const char* symbolName);
 typedef void* (_H6N_SPEC* createInterface_t)(const char* name, int version);
 typedef void* (_H6N_SPEC* flattenArgs_t)(int argc, char** argv, char* out, unsigned int outLength);
 typedef unsigned int (_H6N_SPEC* flattenArgsLength_t)(int argc, char** argv);
+typedef int (_H6N_SPEC* enumerateInterfaces_t)(H6N_InterfaceInfo* out, int outCount);
+typedef int (_H6N_SPEC* createInterfaces_t)(H6N_InterfaceRequest* requests, int count);
 
 
 typedef struct {
@@ -44,6 +24,12 @@ typedef struct {
 	PlatformMutex mutex;
 } ModuleState;
 
+typedef struct {
+	ModuleState module;
+	enumerateInterfaces_t enumerateInterfaces;
+	createInterfaces_t createInterfaces;
+} AgentState;
+
 typedef struct {
 	ModuleState module;
 	flattenArgs_t flattenArgs;
@@ -51,7 +37,7 @@ typedef struct {
 } CapsuleState;
 
 
-ModuleState GAgent = { 0 };
+AgentState GAgent = { 0 };
 CapsuleState GCapsule = { 0 };
 
 
@@ -79,7 +65,48 @@ bool AcquireModule(ModuleState& state, const char* modulePath, const char* ciNam
 }
 
 bool AcquireAgent() {
-	return AcquireModule(GAgent, H6N_AGENT_MODULE, "Agent_createInterface");
+	if (!AcquireModule(GAgent.module, H6N_AGENT_MODULE, "Agent_createInterface"))
+		return false;
+
+	// Optional -- no shipping agent exports these yet, in which case libh6n resolves and probes on its behalf
+	GAgent.enumerateInterfaces = (enumerateInterfaces_t)Platform_moduleSymbol(GAgent.module.handle, "Agent_enumerateInterfaces");
+	GAgent.createInterfaces = (createInterfaces_t)Platform_moduleSymbol(GAgent.module.handle, "Agent_createInterfaces");
+
+	return true;
+}
+
+/*
+ * Interfaces known to this SDK version, used to enumerate interfaces on agents which can't do it themselves
+ */
+const H6N_InterfaceInfo KnownInterfaces[] = {
+	{ H6AC_CLIENT_INTERFACE, H6AC_CLIENT_V2_VERSION },
+	{ H6AC_SERVER_INTERFACE, H6AC_SERVER_VERSION },
+	{ H6AC_REPORT_INTERFACE, H6AC_REPORT_VERSION },
+	{ H6AC_TRANSFER_INTERFACE, H6AC_TRANSFER_VERSION },
+	{ H6AC_TOKEN_POOL_INTERFACE, H6AC_TOKEN_POOL_VERSION },
+	{ H6AC_RESUMPTION_INTERFACE, H6AC_RESUMPTION_VERSION },
+};
+
+// Must be called with the agent mutex held. Versions newer than this SDK knows about are not probed.
+int ProbeInterfaces(H6N_InterfaceInfo* out, int outCount) {
+	int count = 0;
+
+	for (const H6N_InterfaceInfo& known : KnownInterfaces) {
+		for (int version = known.maxVersion; version > 0; version--) {
+			void* iface = GAgent.module.createInterface(known.name, version);
+			if (iface == 0 || H6N_IS_ERROR(iface))
+				continue;
+
+			if (out != 0 && count < outCount) {
+				out[count].name = known.name;
+				out[count].maxVersion = version;
+			}
+			count++;
+			break;
+		}
+	}
+
+	return count;
 }
 
 bool AcquireCapsule() {
@@ -103,13 +130,359 @@ H6ACClient* Agent_createClient() {
 	return (H6ACClient*)Agent_createInterface(H6AC_CLIENT_INTERFACE, H6AC_CLIENT_VERSION);
 }
 
+H6ACClientV2* Agent_createClientV2() {
+	return (H6ACClientV2*)Agent_createInterface(H6AC_CLIENT_INTERFACE, H6AC_CLIENT_V2_VERSION);
+}
+
 H6ACReport* Agent_createReport() {
 	return (H6ACReport*)Agent_createInterface(H6AC_REPORT_INTERFACE, H6AC_REPORT_VERSION);
 }
 
+H6ACTransfer* Agent_createTransfer() {
+	return (H6ACTransfer*)Agent_createInterface(H6AC_TRANSFER_INTERFACE, H6AC_TRANSFER_VERSION);
+}
+
+H6ACTokenPool* Agent_createTokenPool() {
+	return (H6ACTokenPool*)Agent_createInterface(H6AC_TOKEN_POOL_INTERFACE, H6AC_TOKEN_POOL_VERSION);
+}
+
+H6ACResumption* Agent_createResumption() {
+	return (H6ACResumption*)Agent_createInterface(H6AC_RESUMPTION_INTERFACE, H6AC_RESUMPTION_VERSION);
+}
+
+
+/*
+ * libcapsules from before launchv only provide version 1 of H6Capsule, which version 2 starts with. Those are handed
+ * out as version 2 with launchv left unset, forwarding to the version 1 interface most recently acquired, as
+ * libcapsule may have been reloaded since.
+ */
+std::atomic<H6NSDK_INTERFACE(H6Capsule, 1)*> LegacyCapsule(0);
+
+long LegacyCapsuleLaunch(const char* targetProcess, H6N_IntegrationID id, char* args) {
+	return LegacyCapsule.load()->launch(targetProcess, id, args);
+}
+
+void LegacyCapsuleErrorCallback(Capsule_errorCallback errorCallback) {
+	LegacyCapsule.load()->errorCallback(errorCallback);
+}
+
+void LegacyCapsuleProgressCallback(Capsule_progressCallback progressCallback) {
+	LegacyCapsule.load()->progressCallback(progressCallback);
+}
+
+const H6NSDK_INTERFACE(H6Capsule, 2) LegacyCapsuleV2 = {
+	LegacyCapsuleLaunch,
+	LegacyCapsuleErrorCallback,
+	LegacyCapsuleProgressCallback,
+	0,
+};
 
 H6Capsule* Capsule_createCapsule() {
-	return (H6Capsule*)Capsule_createInterface(H6N_CAPSULE_INTERFACE, H6N_CAPSULE_VERSION);
+	void* capsule = Capsule_createInterface(H6N_CAPSULE_INTERFACE, H6N_CAPSULE_VERSION);
+	if (capsule == H6N_ERROR_INTERFACE_NOT_FOUND) {
+		void* legacy = Capsule_createInterface(H6N_CAPSULE_INTERFACE, 1);
+		if (legacy == 0 || H6N_IS_ERROR(legacy))
+			return (H6Capsule*)capsule;
+
+		LegacyCapsule = (H6NSDK_INTERFACE(H6Capsule, 1)*)legacy;
+		return (H6Capsule*)&LegacyCapsuleV2;
+	}
+	return (H6Capsule*)capsule;
+}
+
+
+/*
+ * Call capture
+ *
+ * While a capture is running, interfaces handed out by Agent_createInterface are replaced with
+ * recording wrappers that append a record to the capture file and then forward to the agent.
+ * Interface functions carry no context, so the wrapped interfaces are kept globally; the agent
+ * hands out a single instance of each interface anyway. Records are appended lock-free by
+ * reserving space with an atomic add, so capturing doesn't serialize callers.
+ */
+
+typedef struct {
+	PlatformMappedFile file;
+	uint64_t startMicros;
+	std::atomic<bool> active;
+	std::atomic<int> writers;
+	std::atomic<uint64_t> offset;
+	PlatformMutex mutex;
+} CaptureState;
+
+CaptureState GCapture;
+
+// Set by whichever thread acquires an interface while other threads may already be calling through its wrapper
+std::atomic<H6ACServer*> CapturedServer(0);
+std::atomic<H6ACClient*> CapturedClient(0);
+std::atomic<H6ACClientV2*> CapturedClientV2(0);
+std::atomic<H6ACReport*> CapturedReport(0);
+std::atomic<H6ACTransfer*> CapturedTransfer(0);
+std::atomic<H6ACResumption*> CapturedResumption(0);
+
+std::atomic<H6NSDK_INTERFACE(H6ACServer_kickCallback, 1)> CapturedKickCallback(0);
+std::atomic<H6NSDK_INTERFACE(H6ACServer_attestationCallback, 1)> CapturedAttestationCallback(0);
+std::atomic<H6NSDK_INTERFACE(H6ACServer_updateCallback, 1)> CapturedUpdateCallback(0);
+
+void CaptureAppend(uint16_t type, const void* first, uint32_t firstLength, const void* second, uint32_t secondLength) {
+	GCapture.writers++;
+	if (!GCapture.active) {
+		GCapture.writers--;
+		return;
+	}
+
+	uint32_t length = firstLength + secondLength;
+	if (length > 0xFFFF) {
+		secondLength = 0xFFFF - firstLength;
+		length = 0xFFFF;
+	}
+
+	uint64_t size = sizeof(CaptureRecord) + ((length + CAPTURE_ALIGN - 1) & ~(uint64_t)(CAPTURE_ALIGN - 1));
+	uint64_t offset = GCapture.offset.fetch_add(size);
+
+	// Once the file is full, further records are dropped
+	if (offset + size <= GCapture.file.size) {
+		uint8_t* out = (uint8_t*)GCapture.file.base + offset;
+
+		CaptureRecord record;
+		record.timeMicros = Platform_tickMicros() - GCapture.startMicros;
+		record.type = type;
+		record.length = (uint16_t)length;
+		record.reserved = 0;
+
+		memcpy(out + sizeof(record), first, firstLength);
+		memcpy(out + sizeof(record) + firstLength, second, secondLength);
+		memcpy(out, &record, sizeof(record));
+	}
+
+	GCapture.writers--;
+}
+
+void CaptureCall(uint16_t type, const void* payload, uint32_t length) {
+	CaptureAppend(type, payload, length, 0, 0);
+}
+
+void CapturePlayer(uint16_t type, H6N_PlayerID playerID, uint32_t value) {
+	CaptureAppend(type, &playerID, sizeof(playerID), &value, sizeof(value));
+}
+
+// Records a call whose outcome depends on data that isn't captured, once its result is known
+void CapturePlayerResult(uint16_t type, H6N_PlayerID playerID, uint32_t value, int result) {
+	int32_t values[2] = { (int32_t)value, result };
+	CaptureAppend(type, &playerID, sizeof(playerID), values, sizeof(values));
+}
+
+// Callbacks from the agent
+
+int CaptureKickCallback(H6N_PlayerID playerID, const char* reason) {
+	CaptureAppend(CAPTURE_CALLBACK_KICK, &playerID, sizeof(playerID), reason, reason != 0 ? (uint32_t)strlen(reason) : 0);
+	H6NSDK_INTERFACE(H6ACServer_kickCallback, 1) callback = CapturedKickCallback.load();
+	return callback != 0 ? callback(playerID, reason) : 0;
+}
+
+void CaptureAttestationCallback(H6N_PlayerID playerID, uint8_t* attestation, unsigned int length) {
+	CapturePlayer(CAPTURE_CALLBACK_ATTESTATION, playerID, length);
+	H6NSDK_INTERFACE(H6ACServer_attestationCallback, 1) callback = CapturedAttestationCallback.load();
+	if (callback != 0)
+		callback(playerID, attestation, length);
+}
+
+void CaptureUpdateCallback() {
+	CaptureCall(CAPTURE_CALLBACK_UPDATE, 0, 0);
+	H6NSDK_INTERFACE(H6ACServer_updateCallback, 1) callback = CapturedUpdateCallback.load();
+	if (callback != 0)
+		callback();
+}
+
+// H6ACServer
+
+void CaptureServerBegin(H6N_IntegrationID integrationID) {
+	CaptureCall(CAPTURE_SERVER_BEGIN, &integrationID, sizeof(integrationID));
+	CapturedServer.load()->begin(integrationID);
+}
+
+void CaptureServerEnd() {
+	CaptureCall(CAPTURE_SERVER_END, 0, 0);
+	CapturedServer.load()->end();
+}
+
+void CaptureServerRegister(H6N_PlayerID playerID, const uint8_t* sharedSecret, unsigned int sharedSecretLen) {
+	CapturePlayer(CAPTURE_SERVER_REGISTER, playerID, sharedSecretLen);
+	CapturedServer.load()->registerPlayer(playerID, sharedSecret, sharedSecretLen);
+}
+
+void CaptureServerUnregister(H6N_PlayerID playerID) {
+	CaptureCall(CAPTURE_SERVER_UNREGISTER, &playerID, sizeof(playerID));
+	CapturedServer.load()->unregisterPlayer(playerID);
+}
+
+void CaptureServerKickCallback(H6NSDK_INTERFACE(H6ACServer_kickCallback, 1) callback) {
+	CapturedKickCallback = callback;
+	CapturedServer.load()->setKickCallback(callback != 0 ? CaptureKickCallback : 0);
+}
+
+void CaptureServerAttestationCallback(H6NSDK_INTERFACE(H6ACServer_attestationCallback, 1) callback) {
+	CapturedAttestationCallback = callback;
+	CapturedServer.load()->setAttestationCallback(callback != 0 ? CaptureAttestationCallback : 0);
+}
+
+void CaptureServerUpdateCallback(H6NSDK_INTERFACE(H6ACServer_updateCallback, 1) callback) {
+	CapturedUpdateCallback = callback;
+	CapturedServer.load()->setUpdateCallback(callback != 0 ? CaptureUpdateCallback : 0);
+}
+
+const H6NSDK_INTERFACE(H6ACServer, 1) CaptureServer = {
+	CaptureServerBegin,
+	CaptureServerEnd,
+	CaptureServerRegister,
+	CaptureServerUnregister,
+	CaptureServerKickCallback,
+	CaptureServerAttestationCallback,
+	CaptureServerUpdateCallback,
+};
+
+// H6ACClient
+
+void CaptureClientPlayerID(H6N_PlayerID playerID) {
+	CaptureCall(CAPTURE_CLIENT_PLAYER_ID, &playerID, sizeof(playerID));
+	CapturedClient.load()->setPlayerUniqueID(playerID);
+}
+
+int CaptureClientIsPlayerIDAcquired() {
+	return CapturedClient.load()->isPlayerIDAquired();
+}
+
+void CaptureClientSecret(const uint8_t* sharedSecret, unsigned int sharedSecretLen) {
+	uint32_t length = sharedSecretLen;
+	CaptureCall(CAPTURE_CLIENT_SECRET, &length, sizeof(length));
+	CapturedClient.load()->setSharedSecret(sharedSecret, sharedSecretLen);
+}
+
+void CaptureClientAttestation(uint8_t* attestation, unsigned int length) {
+	uint32_t recorded = length;
+	CaptureCall(CAPTURE_CLIENT_ATTESTATION, &recorded, sizeof(recorded));
+	CapturedClient.load()->submitClientAttestation(attestation, length);
+}
+
+void CaptureClientDisconnect() {
+	CaptureCall(CAPTURE_CLIENT_DISCONNECT, 0, 0);
+	CapturedClient.load()->disconnect();
+}
+
+void CaptureClientResumptionTicket(const uint8_t* ticket, unsigned int length) {
+	uint32_t recorded = length;
+	CaptureCall(CAPTURE_CLIENT_RESUME, &recorded, sizeof(recorded));
+	CapturedClientV2.load()->submitResumptionTicket(ticket, length);
+}
+
+const H6ACClient CaptureClient = {
+	CaptureClientPlayerID,
+	CaptureClientIsPlayerIDAcquired,
+	CaptureClientSecret,
+	CaptureClientAttestation,
+	CaptureClientDisconnect,
+};
+
+const H6ACClientV2 CaptureClientV2 = {
+	CaptureClientPlayerID,
+	CaptureClientIsPlayerIDAcquired,
+	CaptureClientSecret,
+	CaptureClientAttestation,
+	CaptureClientDisconnect,
+	CaptureClientResumptionTicket,
+};
+
+// H6ACReport
+
+void CaptureReportPlayer(H6N_PlayerID playerID, int reserved) {
+	CapturePlayer(CAPTURE_REPORT_PLAYER, playerID, (uint32_t)reserved);
+	CapturedReport.load()->reportPlayer(playerID, reserved);
+}
+
+const H6NSDK_INTERFACE(H6ACReport, 1) CaptureReport = {
+	CaptureReportPlayer,
+};
+
+// H6ACTransfer
+
+unsigned int CaptureTransferExport(H6N_PlayerID playerID, uint8_t* out, unsigned int outLength) {
+	CapturePlayer(CAPTURE_TRANSFER_EXPORT, playerID, out != 0 ? outLength : 0);
+	return CapturedTransfer.load()->exportPlayer(playerID, out, outLength);
+}
+
+int CaptureTransferImport(H6N_PlayerID playerID, const uint8_t* state, unsigned int length) {
+	int result = CapturedTransfer.load()->importPlayer(playerID, state, length);
+	CapturePlayerResult(CAPTURE_TRANSFER_IMPORT, playerID, length, result);
+	return result;
+}
+
+const H6NSDK_INTERFACE(H6ACTransfer, 1) CaptureTransfer = {
+	CaptureTransferExport,
+	CaptureTransferImport,
+};
+
+// H6ACResumption
+
+void CaptureResumptionLifetime(unsigned int lifetimeSeconds) {
+	uint32_t recorded = lifetimeSeconds;
+	CaptureCall(CAPTURE_RESUMPTION_LIFETIME, &recorded, sizeof(recorded));
+	CapturedResumption.load()->setTicketLifetime(lifetimeSeconds);
+}
+
+unsigned int CaptureResumptionIssue(H6N_PlayerID playerID, uint8_t* out, unsigned int outLength) {
+	CapturePlayer(CAPTURE_RESUMPTION_ISSUE, playerID, out != 0 ? outLength : 0);
+	return CapturedResumption.load()->issueTicket(playerID, out, outLength);
+}
+
+int CaptureResumptionResume(H6N_PlayerID playerID, const uint8_t* ticket, unsigned int length) {
+	int result = CapturedResumption.load()->resumePlayer(playerID, ticket, length);
+	CapturePlayerResult(CAPTURE_RESUMPTION_RESUME, playerID, length, result);
+	return result;
+}
+
+const H6NSDK_INTERFACE(H6ACResumption, 1) CaptureResumption = {
+	CaptureResumptionLifetime,
+	CaptureResumptionIssue,
+	CaptureResumptionResume,
+};
+
+// Swaps an interface fresh from the agent for its recording wrapper, if a capture is running
+void* CaptureInterface(const char* name, int version, void* iface) {
+	if (!GCapture.active || iface == 0 || H6N_IS_ERROR(iface))
+		return iface;
+
+	// Version 2 of H6ACClient starts with the functions of version 1, so both share the version 1 wrappers
+	if (strcmp(name, H6AC_CLIENT_INTERFACE) == 0 && version == H6AC_CLIENT_V2_VERSION) {
+		CapturedClient = (H6ACClient*)iface;
+		CapturedClientV2 = (H6ACClientV2*)iface;
+		return (void*)&CaptureClientV2;
+	}
+
+	if (version != 1)
+		return iface;
+
+	if (strcmp(name, H6AC_SERVER_INTERFACE) == 0) {
+		CapturedServer = (H6ACServer*)iface;
+		return (void*)&CaptureServer;
+	}
+	if (strcmp(name, H6AC_CLIENT_INTERFACE) == 0) {
+		CapturedClient = (H6ACClient*)iface;
+		return (void*)&CaptureClient;
+	}
+	if (strcmp(name, H6AC_REPORT_INTERFACE) == 0) {
+		CapturedReport = (H6ACReport*)iface;
+		return (void*)&CaptureReport;
+	}
+	if (strcmp(name, H6AC_TRANSFER_INTERFACE) == 0) {
+		CapturedTransfer = (H6ACTransfer*)iface;
+		return (void*)&CaptureTransfer;
+	}
+	if (strcmp(name, H6AC_RESUMPTION_INTERFACE) == 0) {
+		CapturedResumption = (H6ACResumption*)iface;
+		return (void*)&CaptureResumption;
+	}
+
+	return iface;
 }
 
 
@@ -120,12 +493,57 @@ H6Capsule* Capsule_createCapsule() {
 extern "C" {
 
 	void H6N_initialize() {
-		InitModule(GAgent);
+		InitModule(GAgent.module);
 		InitModule(GCapsule.module);
+		Platform_initMutex(&GCapture.mutex);
+	}
+
+	int H6N_beginCapture(const char* path, unsigned int capacity) {
+		Platform_enterMutex(&GCapture.mutex);
+
+		if (GCapture.active || capacity < sizeof(CaptureHeader)
+			|| !Platform_createMappedFile(&GCapture.file, path, capacity)) {
+			Platform_leaveMutex(&GCapture.mutex);
+			return 0;
+		}
+
+		CaptureHeader header;
+		header.magic = CAPTURE_MAGIC;
+		header.version = CAPTURE_VERSION;
+		header.reserved = 0;
+		memcpy(GCapture.file.base, &header, sizeof(header));
+
+		GCapture.offset = sizeof(header);
+		GCapture.startMicros = Platform_tickMicros();
+		GCapture.active = true;
+
+		Platform_leaveMutex(&GCapture.mutex);
+		return 1;
+	}
+
+	void H6N_endCapture() {
+		Platform_enterMutex(&GCapture.mutex);
+
+		if (!GCapture.active) {
+			Platform_leaveMutex(&GCapture.mutex);
+			return;
+		}
+
+		// Wait out records still being written before unmapping the file from under them
+		GCapture.active = false;
+		while (GCapture.writers != 0)
+			Platform_sleepMicros(0);
+
+		uint64_t length = GCapture.offset;
+		if (length > GCapture.file.size)
+			length = GCapture.file.size;
+		Platform_freeMappedFile(&GCapture.file, (size_t)length);
+
+		Platform_leaveMutex(&GCapture.mutex);
 	}
 
 	void Agent_release() {
-		ReleaseModule(GAgent);
+		ReleaseModule(GAgent.module);
 	}
 
 	void Capsule_release() {
@@ -133,18 +551,63 @@ extern "C" {
 	}
 
 	void* _H6N_SPEC Agent_createInterface(const char* name, int version) {
-		Platform_enterMutex(&GAgent.mutex);
+		Platform_enterMutex(&GAgent.module.mutex);
 
 		if (!AcquireAgent()) {
-			Platform_leaveMutex(&GAgent.mutex);
+			Platform_leaveMutex(&GAgent.module.mutex);
 			return H6N_ERROR_MODULE_NOT_FOUND;
 		}
 
-		void* result = GAgent.createInterface(name, version);
-		Platform_leaveMutex(&GAgent.mutex);
+		void* result = CaptureInterface(name, version, GAgent.module.createInterface(name, version));
+		Platform_leaveMutex(&GAgent.module.mutex);
+		return result;
+	}
+
+	int Agent_enumerateInterfaces(H6N_InterfaceInfo* out, int outCount) {
+		Platform_enterMutex(&GAgent.module.mutex);
+
+		if (!AcquireAgent()) {
+			Platform_leaveMutex(&GAgent.module.mutex);
+			return -1;
+		}
+
+		int result = GAgent.enumerateInterfaces != 0
+			? GAgent.enumerateInterfaces(out, outCount)
+			: ProbeInterfaces(out, outCount);
+		Platform_leaveMutex(&GAgent.module.mutex);
 		return result;
 	}
 
+	int Agent_createInterfaces(H6N_InterfaceRequest* requests, int count) {
+		Platform_enterMutex(&GAgent.module.mutex);
+
+		if (!AcquireAgent()) {
+			for (int i = 0; i < count; i++)
+				requests[i].result = H6N_ERROR_MODULE_NOT_FOUND;
+
+			Platform_leaveMutex(&GAgent.module.mutex);
+			return 0;
+		}
+
+		// Agents that can resolve a batch themselves do so; otherwise, resolve each request in turn
+		if (GAgent.createInterfaces != 0)
+			GAgent.createInterfaces(requests, count);
+		else {
+			for (int i = 0; i < count; i++)
+				requests[i].result = GAgent.module.createInterface(requests[i].name, requests[i].version);
+		}
+
+		int resolved = 0;
+		for (int i = 0; i < count; i++) {
+			requests[i].result = CaptureInterface(requests[i].name, requests[i].version, requests[i].result);
+			if (requests[i].result != 0 && H6N_NO_ERROR(requests[i].result))
+				resolved++;
+		}
+
+		Platform_leaveMutex(&GAgent.module.mutex);
+		return resolved;
+	}
+
 	void* _H6N_SPEC Capsule_createInterface(const char* name, int version) {
 		Platform_enterMutex(&GCapsule.module.mutex);
 
@@ -167,6 +630,7 @@ extern "C" {
 		}
 
 		GCapsule.flattenArgs(argc, argv, out, outLength);
+		Platform_leaveMutex(&GCapsule.module.mutex);
 	}
 
 
@@ -178,7 +642,7 @@ extern "C" {
 			return 0;
 		}
 
-		int result = GCapsule.flattenArgsLen(argc, argv);
+		unsigned int result = GCapsule.flattenArgsLen(argc, argv);
 		Platform_leaveMutex(&GCapsule.module.mutex);
 		return result;
 	}
@@ -193,6 +657,10 @@ void Platform_initMutex(PlatformMutex* mutex) {
 	InitializeCriticalSection(mutex);
 }
 
+void Platform_freeMutex(PlatformMutex* mutex) {
+	DeleteCriticalSection(mutex);
+}
+
 void Platform_enterMutex(PlatformMutex* mutex) {
 	EnterCriticalSection(mutex);
 }
@@ -213,14 +681,204 @@ void* Platform_moduleSymbol(void* handle, const char* symbolName) {
 	return (void*)GetProcAddress((HMODULE)handle, symbolName);
 }
 
+uint64_t Platform_tickMillis() {
+	// GetTickCount64 isn't available on Windows XP
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / (frequency.QuadPart / 1000));
+}
+
+uint64_t Platform_tickMicros() {
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+
+	// Split the conversion so the multiplication can't overflow
+	uint64_t seconds = counter.QuadPart / frequency.QuadPart;
+	uint64_t remainder = counter.QuadPart % frequency.QuadPart;
+	return seconds * 1000000 + remainder * 1000000 / frequency.QuadPart;
+}
+
+void Platform_sleepMicros(uint64_t micros) {
+	Sleep((DWORD)(micros / 1000));
+}
+
+unsigned long Platform_processID() {
+	return GetCurrentProcessId();
+}
+
+int Platform_processAlive(unsigned long processID) {
+	HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)processID);
+	if (process == 0)
+		return GetLastError() == ERROR_ACCESS_DENIED;
+
+	int alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+	CloseHandle(process);
+	return alive;
+}
+
+uint64_t Platform_processStartTime(unsigned long processID) {
+	HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, (DWORD)processID);
+	if (process == 0)
+		return 0;
+
+	FILETIME created, exited, kernel, user;
+	uint64_t startTime = 0;
+	if (GetProcessTimes(process, &created, &exited, &kernel, &user))
+		startTime = ((uint64_t)created.dwHighDateTime << 32) | created.dwLowDateTime;
+
+	CloseHandle(process);
+	return startTime;
+}
+
+void Platform_setEnvironment(const char* name, const char* value) {
+	SetEnvironmentVariableA(name, value);
+}
+
+int Platform_getEnvironment(const char* name, char* out, unsigned int outLength) {
+	DWORD length = GetEnvironmentVariableA(name, out, outLength);
+	return length != 0 && length < outLength;
+}
+
+static int MapSharedMemory(PlatformSharedMemory* memory, HANDLE mapping, const char* name, size_t size) {
+	memory->base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (memory->base == 0) {
+		CloseHandle(mapping);
+		return 0;
+	}
+
+	memory->size = size;
+	memory->handle = mapping;
+	lstrcpynA(memory->name, name, sizeof(memory->name));
+	return 1;
+}
+
+int Platform_createSharedMemory(PlatformSharedMemory* memory, const char* name, size_t size) {
+	// Page-file backed mappings are zero-filled and go away with their last handle
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE,
+		(DWORD)((uint64_t)size >> 32), (DWORD)size, name);
+	if (mapping == 0)
+		return 0;
+
+	if (GetLastError() == ERROR_ALREADY_EXISTS) {
+		CloseHandle(mapping);
+		return 0;
+	}
+
+	memory->owner = 1;
+	return MapSharedMemory(memory, mapping, name, size);
+}
+
+int Platform_openSharedMemory(PlatformSharedMemory* memory, const char* name, size_t size, int create) {
+	HANDLE mapping = create
+		? CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, name)
+		: OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+	if (mapping == 0)
+		return 0;
+
+	memory->owner = 0;
+	return MapSharedMemory(memory, mapping, name, size);
+}
+
+void Platform_freeSharedMemory(PlatformSharedMemory* memory) {
+	UnmapViewOfFile(memory->base);
+	CloseHandle((HANDLE)memory->handle);
+	memory->base = 0;
+}
+
+void Platform_unlinkSharedMemory(const char*) {
+	// Named mappings have no name of their own to remove; they go away with their last handle
+}
+
+int Platform_createMappedFile(PlatformMappedFile* mapped, const char* path, size_t size) {
+	HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, 0, CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		return 0;
+
+	HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, 0);
+	void* base = mapping != 0 ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size) : 0;
+	if (base == 0) {
+		if (mapping != 0)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		return 0;
+	}
+
+	mapped->base = base;
+	mapped->size = size;
+	mapped->file = file;
+	mapped->mapping = mapping;
+	mapped->writable = 1;
+	return 1;
+}
+
+int Platform_openMappedFile(PlatformMappedFile* mapped, const char* path) {
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		return 0;
+
+	LARGE_INTEGER size;
+	HANDLE mapping = 0;
+	void* base = 0;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+		mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+		base = mapping != 0 ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+	}
+
+	if (base == 0) {
+		if (mapping != 0)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		return 0;
+	}
+
+	mapped->base = base;
+	mapped->size = (size_t)size.QuadPart;
+	mapped->file = file;
+	mapped->mapping = mapping;
+	mapped->writable = 0;
+	return 1;
+}
+
+void Platform_freeMappedFile(PlatformMappedFile* mapped, size_t length) {
+	UnmapViewOfFile(mapped->base);
+	CloseHandle((HANDLE)mapped->mapping);
+
+	if (mapped->writable) {
+		LARGE_INTEGER position;
+		position.QuadPart = (LONGLONG)length;
+		SetFilePointerEx((HANDLE)mapped->file, position, 0, FILE_BEGIN);
+		SetEndOfFile((HANDLE)mapped->file);
+	}
+
+	CloseHandle((HANDLE)mapped->file);
+	mapped->base = 0;
+}
+
 #elif defined(_H6N_POSIX)
 
 #include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 
 void Platform_initMutex(PlatformMutex* mutex) {
     pthread_mutex_init(mutex, 0);
 }
 
+void Platform_freeMutex(PlatformMutex* mutex) {
+    pthread_mutex_destroy(mutex);
+}
+
 void Platform_enterMutex(PlatformMutex* mutex) {
 	pthread_mutex_lock(mutex);
 }
@@ -241,4 +899,195 @@ void* Platform_moduleSymbol(void* handle, const char* symbolName) {
     return (void*)dlsym(handle, symbolName);
 }
 
+uint64_t Platform_tickMillis() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+uint64_t Platform_tickMicros() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+void Platform_sleepMicros(uint64_t micros) {
+    usleep((useconds_t)micros);
+}
+
+unsigned long Platform_processID() {
+    return (unsigned long)getpid();
+}
+
+int Platform_processAlive(unsigned long processID) {
+    return kill((pid_t)processID, 0) == 0 || errno == EPERM;
+}
+
+uint64_t Platform_processStartTime(unsigned long processID) {
+#if defined(__linux__)
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%lu/stat", processID);
+
+    FILE* file = fopen(path, "r");
+    if (file == 0)
+        return 0;
+
+    char stat[1024];
+    size_t length = fread(stat, 1, sizeof(stat) - 1, file);
+    fclose(file);
+    stat[length] = 0;
+
+    // The start time is the 22nd field; the command name in the 2nd may contain spaces, so count from its end
+    const char* field = strrchr(stat, ')');
+    for (int skip = 0; field != 0 && skip < 20; skip++)
+        field = strchr(field + 1, ' ');
+
+    return field != 0 ? strtoull(field + 1, 0, 10) : 0;
+#else
+    (void)processID;
+    return 0;
+#endif
+}
+
+void Platform_setEnvironment(const char* name, const char* value) {
+    if (value != 0)
+        setenv(name, value, 1);
+    else
+        unsetenv(name);
+}
+
+int Platform_getEnvironment(const char* name, char* out, unsigned int outLength) {
+    const char* value = getenv(name);
+    if (value == 0 || strlen(value) >= outLength)
+        return 0;
+
+    strcpy(out, value);
+    return 1;
+}
+
+static int MapSharedMemory(PlatformSharedMemory* memory, int fd, const char* name, size_t size) {
+    void* base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return 0;
+
+    memory->base = base;
+    memory->size = size;
+    memory->handle = 0;
+    strncpy(memory->name, name, sizeof(memory->name) - 1);
+    memory->name[sizeof(memory->name) - 1] = 0;
+    return 1;
+}
+
+int Platform_createSharedMemory(PlatformSharedMemory* memory, const char* name, size_t size) {
+    // POSIX shared memory names must start with a slash
+    char path[sizeof(memory->name) + 1];
+    snprintf(path, sizeof(path), "/%s", name);
+
+    int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return 0;
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(path);
+        return 0;
+    }
+
+    memory->owner = 1;
+    if (!MapSharedMemory(memory, fd, name, size)) {
+        shm_unlink(path);
+        return 0;
+    }
+    return 1;
+}
+
+int Platform_openSharedMemory(PlatformSharedMemory* memory, const char* name, size_t size, int create) {
+    char path[sizeof(memory->name) + 1];
+    snprintf(path, sizeof(path), "/%s", name);
+
+    int fd = shm_open(path, create ? O_RDWR | O_CREAT : O_RDWR, 0600);
+    if (fd < 0)
+        return 0;
+
+    // Growing a region someone else sized is harmless, and a fresh one needs sizing before mapping
+    struct stat info;
+    if (fstat(fd, &info) != 0 || ((size_t)info.st_size < size && ftruncate(fd, (off_t)size) != 0)) {
+        close(fd);
+        return 0;
+    }
+
+    memory->owner = 0;
+    return MapSharedMemory(memory, fd, name, size);
+}
+
+void Platform_freeSharedMemory(PlatformSharedMemory* memory) {
+    munmap(memory->base, memory->size);
+    memory->base = 0;
+
+    if (memory->owner)
+        Platform_unlinkSharedMemory(memory->name);
+}
+
+void Platform_unlinkSharedMemory(const char* name) {
+    char path[sizeof(((PlatformSharedMemory*)0)->name) + 1];
+    snprintf(path, sizeof(path), "/%s", name);
+    shm_unlink(path);
+}
+
+int Platform_createMappedFile(PlatformMappedFile* mapped, const char* path, size_t size) {
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return 0;
+
+    void* base = ftruncate(fd, (off_t)size) == 0
+        ? mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+        : MAP_FAILED;
+    if (base == MAP_FAILED) {
+        close(fd);
+        return 0;
+    }
+
+    mapped->base = base;
+    mapped->size = size;
+    mapped->file = (void*)(intptr_t)fd;
+    mapped->mapping = 0;
+    mapped->writable = 1;
+    return 1;
+}
+
+int Platform_openMappedFile(PlatformMappedFile* mapped, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    struct stat info;
+    void* base = fstat(fd, &info) == 0 && info.st_size > 0
+        ? mmap(0, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0)
+        : MAP_FAILED;
+    close(fd);
+    if (base == MAP_FAILED)
+        return 0;
+
+    mapped->base = base;
+    mapped->size = (size_t)info.st_size;
+    mapped->file = (void*)(intptr_t)-1;
+    mapped->mapping = 0;
+    mapped->writable = 0;
+    return 1;
+}
+
+void Platform_freeMappedFile(PlatformMappedFile* mapped, size_t length) {
+    munmap(mapped->base, mapped->size);
+    mapped->base = 0;
+
+    if (mapped->writable) {
+        int fd = (int)(intptr_t)mapped->file;
+        if (ftruncate(fd, (off_t)length) != 0) {
+            // Leave the file at its full size; readers stop at the first empty record anyway
+        }
+        close(fd);
+    }
+}
+
 #endif
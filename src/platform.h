@@ -0,0 +1,82 @@
+/*
+ * Platform layer
+ *
+ * While H6NSDK is internally built inside the monorepo source tree, this library may need to
+ * be built by customers in a shared-source agreement. As such, we cannot use the platform
+ * abstraction layer in libagent and must re-implement platform-dependent units in here.
+ */
+
+#ifndef _H6NSDK_PLATFORM_H
+#define _H6NSDK_PLATFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <Windows.h>
+typedef CRITICAL_SECTION PlatformMutex;
+#elif defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+typedef pthread_mutex_t PlatformMutex;
+#define _H6N_POSIX
+#endif
+
+
+void Platform_initMutex(PlatformMutex* mutex);
+void Platform_freeMutex(PlatformMutex* mutex);
+void Platform_enterMutex(PlatformMutex* mutex);
+void Platform_leaveMutex(PlatformMutex* mutex);
+
+void* Platform_acquireModule(const char* moduleName);
+void Platform_freeModule(void* handle);
+void* Platform_moduleSymbol(void* handle, const char* symbolName);
+
+// Monotonic milliseconds since an unspecified point in time
+uint64_t Platform_tickMillis();
+// Monotonic microseconds since an unspecified point in time
+uint64_t Platform_tickMicros();
+void Platform_sleepMicros(uint64_t micros);
+
+unsigned long Platform_processID();
+// Returns 0 only if no process with the ID exists
+int Platform_processAlive(unsigned long processID);
+// Returns an opaque value that differs between processes that have had the same ID, or 0 if it can't be determined
+uint64_t Platform_processStartTime(unsigned long processID);
+
+// Sets an environment variable that processes launched from this one will inherit, or removes it if value is 0
+void Platform_setEnvironment(const char* name, const char* value);
+// Returns 0 if the variable isn't set, or if it doesn't fit in outLength bytes
+int Platform_getEnvironment(const char* name, char* out, unsigned int outLength);
+
+typedef struct {
+	void* base;
+	size_t size;
+	void* handle;
+	int owner;
+	char name[64];
+} PlatformSharedMemory;
+
+// Creates a named, zero-filled shared memory region. The name is unlinked again when the creator frees it.
+int Platform_createSharedMemory(PlatformSharedMemory* memory, const char* name, size_t size);
+// Opens an existing shared memory region, or creates it if `create` is set and it doesn't exist yet
+int Platform_openSharedMemory(PlatformSharedMemory* memory, const char* name, size_t size, int create);
+void Platform_freeSharedMemory(PlatformSharedMemory* memory);
+// Removes a region's name, so that it's freed once the processes using it are done. Regions outlive their creator.
+void Platform_unlinkSharedMemory(const char* name);
+
+typedef struct {
+	void* base;
+	size_t size;
+	void* file;
+	void* mapping;
+	int writable;
+} PlatformMappedFile;
+
+// Creates (or truncates) a file of the specified size and maps it for writing
+int Platform_createMappedFile(PlatformMappedFile* mapped, const char* path, size_t size);
+// Maps an entire existing file for reading
+int Platform_openMappedFile(PlatformMappedFile* mapped, const char* path);
+// Unmaps a file, truncating it to `length` bytes first if it was mapped for writing
+void Platform_freeMappedFile(PlatformMappedFile* mapped, size_t length);
+
+#endif //_H6NSDK_PLATFORM_H
@@ -0,0 +1,415 @@
+#include "libh6n/registry.h"
+#include "platform.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+
+/*
+ * Shared player registry
+ *
+ * An open-addressed hash table with linear probing, laid out in a shared memory region after a
+ * small header. Slots are never emptied once used, so probe chains stay intact; instead, an
+ * expired or withdrawn slot is taken over by the next player published into its chain. The
+ * header records the longest distance any entry has been placed from its home slot, so a lookup
+ * for a player that isn't there stops after that many probes rather than walking every slot
+ * the host has ever used.
+ *
+ * Each slot is guarded by a sequence lock. Readers copy a slot optimistically and retry if its
+ * sequence changed underneath them. Writers take the slot by moving its sequence from even to
+ * odd, recording their process ID alongside it in the same word, and then their start time. A
+ * slot held by a process that has died is taken over and its entry marked lapsed, so a crash
+ * mid-write can't leave a slot locked for as long as the region exists. A writer that is merely
+ * slow is never taken over, as it would go on to finish its copy over the new owner's. The start
+ * time tells a dead writer from a new process that was given its ID; process IDs are only
+ * meaningful within one PID namespace, so every process sharing a registry must be in the same
+ * one. Lookups only ever write to shared memory to take over a slot.
+ *
+ * Players handed over with Registry_publishPlayer are stored with a digest of their shared
+ * secret and exported state, so Registry_adoptPlayer only adopts them for a caller that has the
+ * same secret, and never under a secret other than the one they were verified with.
+ *
+ * Expiry times come from the monotonic clock, which is system-wide on every supported platform,
+ * so they're comparable between processes.
+ */
+
+#define REGISTRY_MAGIC 0x52433648u // "H6CR"
+#define REGISTRY_INITIALIZING 1
+#define REGISTRY_VERSION 3
+
+#define CACHE_LINE 64
+
+// How long to spin on a busy slot or an initializing registry before giving up
+#define SPIN_LIMIT (1 << 20)
+#define INIT_TIMEOUT_MILLIS 1000
+
+// How often to check whether a busy slot's writer is still around
+#define STALE_CHECK_SPINS 1024
+
+// Room for the region name prefix and the longest registry name
+#define REGISTRY_NAME_SIZE sizeof(((PlatformSharedMemory*)0)->name)
+static_assert(sizeof("h6n-registry-") - 1 + H6N_REGISTRY_MAX_NAME < REGISTRY_NAME_SIZE, "registry names don't fit");
+
+// Published players start with a digest binding their state to their shared secret
+#define SECRET_DIGEST_SIZE sizeof(uint64_t)
+
+typedef struct {
+	std::atomic<uint32_t> magic;
+	uint32_t version;
+	uint32_t capacity;
+	std::atomic<uint32_t> maxProbe;
+} RegistryHeader;
+
+typedef struct {
+	// The sequence in the low half, and the process ID of the writer holding the slot in the high half
+	alignas(CACHE_LINE) std::atomic<uint64_t> lock;
+	// The start time of the writer holding the slot, or 0 if it hasn't said yet
+	std::atomic<uint64_t> ownerStarted;
+	std::atomic<uint32_t> used;
+	H6N_PlayerID playerID;
+	uint64_t expiresMillis;
+	uint32_t length;
+	uint8_t state[H6N_REGISTRY_STATE_SIZE];
+} RegistrySlot;
+
+#define SLOTS_OFFSET ((sizeof(RegistryHeader) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1))
+
+struct _H6N_Registry {
+	PlatformSharedMemory memory;
+	RegistryHeader* header;
+	RegistrySlot* slots;
+	uint32_t mask;
+	unsigned int ttlMillis;
+};
+
+typedef struct {
+	H6N_PlayerID playerID;
+	uint64_t expiresMillis;
+	uint32_t length;
+} SlotKey;
+
+
+static uint32_t HashPlayer(const H6N_PlayerID& playerID) {
+	uint64_t hash = (playerID.of64.lo ^ (playerID.of64.hi * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+	return (uint32_t)(hash >> 32);
+}
+
+static uint32_t Sequence(uint64_t lock) {
+	return (uint32_t)lock;
+}
+
+static uint64_t LockWord(uint32_t sequence, uint32_t owner) {
+	return ((uint64_t)owner << 32) | sequence;
+}
+
+static uint32_t OwnProcess() {
+	return (uint32_t)Platform_processID();
+}
+
+static uint64_t OwnStartTime() {
+	static const uint64_t startTime = Platform_processStartTime(Platform_processID());
+	return startTime;
+}
+
+// Whether the process that locked a slot is gone, either outright or replaced by a new process with its ID
+static bool OwnerDied(RegistrySlot& slot, uint64_t lock) {
+	unsigned long owner = (unsigned long)(lock >> 32);
+	if (!Platform_processAlive(owner))
+		return true;
+
+	// Zero until the owner has recorded its start time, and cleared again before the slot is unlocked
+	uint64_t started = slot.ownerStarted.load(std::memory_order_relaxed);
+	uint64_t current = started != 0 ? Platform_processStartTime(owner) : 0;
+	return current != 0 && current != started;
+}
+
+// Takes over a slot whose writer died, leaving it held by this process with its entry lapsed. `lock` must have been
+// loaded with acquire ordering, so the owner's start time is at least as new as the lock.
+static bool TakeOverSlot(RegistrySlot& slot, uint64_t& lock) {
+	if (!OwnerDied(slot, lock))
+		return false;
+
+	uint64_t taken = LockWord(Sequence(lock) + 2, OwnProcess());
+	if (!slot.lock.compare_exchange_strong(lock, taken, std::memory_order_acquire))
+		return false;
+
+	lock = taken;
+	slot.ownerStarted.store(OwnStartTime(), std::memory_order_relaxed);
+	slot.expiresMillis = 0;
+	return true;
+}
+
+static bool LockSlot(RegistrySlot& slot, uint64_t& lock) {
+	for (int spin = 1; spin <= SPIN_LIMIT; spin++) {
+		lock = slot.lock.load(std::memory_order_acquire);
+		if ((Sequence(lock) & 1) == 0) {
+			uint64_t taken = LockWord(Sequence(lock) + 1, OwnProcess());
+			if (slot.lock.compare_exchange_weak(lock, taken, std::memory_order_acquire)) {
+				lock = taken;
+				slot.ownerStarted.store(OwnStartTime(), std::memory_order_relaxed);
+				return true;
+			}
+		} else if (spin % STALE_CHECK_SPINS == 0 && TakeOverSlot(slot, lock)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void UnlockSlot(RegistrySlot& slot, uint64_t lock) {
+	slot.ownerStarted.store(0, std::memory_order_relaxed);
+	slot.lock.store(LockWord(Sequence(lock) + 1, 0), std::memory_order_release);
+}
+
+// Copies a slot's key, and optionally its state, consistently. Returns false if the slot stayed busy.
+static bool ReadSlot(RegistrySlot& slot, SlotKey& key, uint8_t* state, unsigned int stateLength) {
+	for (int spin = 1; spin <= SPIN_LIMIT; spin++) {
+		uint64_t before = slot.lock.load(std::memory_order_acquire);
+		if (Sequence(before) & 1) {
+			if (spin % STALE_CHECK_SPINS == 0 && TakeOverSlot(slot, before))
+				UnlockSlot(slot, before);
+			continue;
+		}
+
+		key.playerID = slot.playerID;
+		key.expiresMillis = slot.expiresMillis;
+		key.length = slot.length;
+		if (state != 0 && key.length <= stateLength && key.length <= H6N_REGISTRY_STATE_SIZE)
+			memcpy(state, slot.state, key.length);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.lock.load(std::memory_order_relaxed) == before)
+			return true;
+	}
+	return false;
+}
+
+// Returns the slot holding the player, or 0 if it isn't in the table
+static RegistrySlot* FindSlot(H6N_Registry* registry, const H6N_PlayerID& playerID) {
+	uint32_t index = HashPlayer(playerID);
+	uint32_t maxProbe = registry->header->maxProbe.load(std::memory_order_acquire);
+
+	for (uint32_t probe = 0; probe <= maxProbe && probe <= registry->mask; probe++) {
+		RegistrySlot& slot = registry->slots[(index + probe) & registry->mask];
+		if (!slot.used.load(std::memory_order_acquire))
+			return 0;
+
+		SlotKey key;
+		if (ReadSlot(slot, key, 0, 0) && key.playerID == playerID)
+			return &slot;
+	}
+	return 0;
+}
+
+// Makes sure lookups probe at least as far as an entry about to be placed this far from its home slot
+static void ExtendProbes(H6N_Registry* registry, uint32_t probe) {
+	uint32_t maxProbe = registry->header->maxProbe.load(std::memory_order_relaxed);
+	while (maxProbe < probe
+		&& !registry->header->maxProbe.compare_exchange_weak(maxProbe, probe, std::memory_order_release))
+		;
+}
+
+// Writes an entry into a slot, provided it is unused, lapsed or already the player's. Returns false otherwise.
+static bool WriteSlot(H6N_Registry* registry, RegistrySlot& slot, const H6N_PlayerID& playerID, const uint8_t* state,
+	unsigned int length, uint64_t now) {
+	uint64_t lock;
+	if (!LockSlot(slot, lock))
+		return false;
+
+	// Someone else may have taken the slot between reading and locking it
+	bool available = !slot.used.load(std::memory_order_relaxed)
+		|| slot.playerID == playerID
+		|| slot.expiresMillis <= now;
+	if (available) {
+		slot.playerID = playerID;
+		slot.expiresMillis = now + registry->ttlMillis;
+		slot.length = length;
+		memcpy(slot.state, state, length);
+		slot.used.store(1, std::memory_order_release);
+	}
+
+	UnlockSlot(slot, lock);
+	return available;
+}
+
+// Returns false if the name is too long to tell apart from other registries' names
+static bool RegionName(const char* name, char (&fullName)[REGISTRY_NAME_SIZE]) {
+	int length = snprintf(fullName, sizeof(fullName), "h6n-registry-%s", name);
+	return length > 0 && (size_t)length < sizeof(fullName);
+}
+
+// FNV-1a over the exported state, then the secret, so the digest can't be extended to other state without the secret
+static uint64_t SecretDigest(const uint8_t* state, unsigned int length, const uint8_t* sharedSecret,
+	unsigned int sharedSecretLen) {
+	uint64_t hash = 14695981039346656037ull;
+	for (unsigned int i = 0; i < length; i++)
+		hash = (hash ^ state[i]) * 1099511628211ull;
+	for (unsigned int i = 0; i < sharedSecretLen; i++)
+		hash = (hash ^ sharedSecret[i]) * 1099511628211ull;
+	return hash;
+}
+
+static bool WaitForInitialization(RegistryHeader* header) {
+	uint64_t deadline = Platform_tickMillis() + INIT_TIMEOUT_MILLIS;
+	while (header->magic.load(std::memory_order_acquire) == REGISTRY_INITIALIZING) {
+		if (Platform_tickMillis() > deadline)
+			return false;
+		Platform_sleepMicros(1000);
+	}
+	return true;
+}
+
+
+/*
+ * Exported function implementation
+ */
+
+extern "C" {
+
+	H6N_Registry* Registry_open(const char* name, unsigned int capacity, unsigned int ttlMillis) {
+		uint32_t slots = 1;
+		while (slots < capacity && slots < 0x40000000u)
+			slots <<= 1;
+
+		char fullName[REGISTRY_NAME_SIZE];
+		if (!RegionName(name, fullName))
+			return 0;
+
+		PlatformSharedMemory memory;
+		if (!Platform_openSharedMemory(&memory, fullName, SLOTS_OFFSET + (size_t)slots * sizeof(RegistrySlot), 1))
+			return 0;
+
+		// Whichever process gets here first lays out the header; the region is zero-filled otherwise
+		RegistryHeader* header = (RegistryHeader*)memory.base;
+		uint32_t expected = 0;
+		if (header->magic.compare_exchange_strong(expected, REGISTRY_INITIALIZING)) {
+			header->version = REGISTRY_VERSION;
+			header->capacity = slots;
+			header->magic.store(REGISTRY_MAGIC, std::memory_order_release);
+		}
+
+		if (!WaitForInitialization(header)
+			|| header->magic.load(std::memory_order_acquire) != REGISTRY_MAGIC
+			|| header->version != REGISTRY_VERSION
+			|| header->capacity != slots) {
+			Platform_freeSharedMemory(&memory);
+			return 0;
+		}
+
+		H6N_Registry* registry = new H6N_Registry();
+		registry->memory = memory;
+		registry->header = header;
+		registry->slots = (RegistrySlot*)((uint8_t*)memory.base + SLOTS_OFFSET);
+		registry->mask = slots - 1;
+		registry->ttlMillis = ttlMillis;
+		return registry;
+	}
+
+	void Registry_unlink(const char* name) {
+		char fullName[REGISTRY_NAME_SIZE];
+		if (RegionName(name, fullName))
+			Platform_unlinkSharedMemory(fullName);
+	}
+
+	void Registry_close(H6N_Registry* registry) {
+		if (registry == 0)
+			return;
+
+		Platform_freeSharedMemory(&registry->memory);
+		delete registry;
+	}
+
+	int Registry_publish(H6N_Registry* registry, H6N_PlayerID playerID, const uint8_t* state, unsigned int length) {
+		if (length > H6N_REGISTRY_STATE_SIZE)
+			return 0;
+
+		uint64_t now = Platform_tickMillis();
+
+		// Prefer the player's existing slot, so a stale copy further along its chain can never resurface
+		RegistrySlot* existing = FindSlot(registry, playerID);
+		if (existing != 0 && WriteSlot(registry, *existing, playerID, state, length, now))
+			return 1;
+
+		uint32_t index = HashPlayer(playerID);
+		for (uint32_t probe = 0; probe <= registry->mask; probe++) {
+			RegistrySlot& slot = registry->slots[(index + probe) & registry->mask];
+
+			// Only never-used slots and slots whose entry has lapsed may be taken over
+			SlotKey key;
+			if (slot.used.load(std::memory_order_acquire)
+				&& (!ReadSlot(slot, key, 0, 0) || key.expiresMillis > now))
+				continue;
+
+			ExtendProbes(registry, probe);
+			if (WriteSlot(registry, slot, playerID, state, length, now))
+				return 1;
+		}
+
+		return 0;
+	}
+
+	unsigned int Registry_lookup(H6N_Registry* registry, H6N_PlayerID playerID, uint8_t* out, unsigned int outLength) {
+		RegistrySlot* slot = FindSlot(registry, playerID);
+		if (slot == 0)
+			return 0;
+
+		SlotKey key;
+		if (!ReadSlot(*slot, key, out, outLength)
+			|| !(key.playerID == playerID)
+			|| key.expiresMillis <= Platform_tickMillis()
+			|| key.length > outLength)
+			return 0;
+
+		return key.length;
+	}
+
+	void Registry_remove(H6N_Registry* registry, H6N_PlayerID playerID) {
+		RegistrySlot* slot = FindSlot(registry, playerID);
+		uint64_t lock;
+		if (slot == 0 || !LockSlot(*slot, lock))
+			return;
+
+		if (slot->playerID == playerID)
+			slot->expiresMillis = 0;
+
+		UnlockSlot(*slot, lock);
+	}
+
+	int Registry_publishPlayer(H6N_Registry* registry, H6ACTransfer* transfer, H6N_PlayerID playerID,
+		const uint8_t* sharedSecret, unsigned int sharedSecretLen) {
+		uint8_t entry[H6N_REGISTRY_STATE_SIZE];
+		uint8_t* state = entry + SECRET_DIGEST_SIZE;
+		unsigned int length = transfer->exportPlayer(playerID, state, sizeof(entry) - SECRET_DIGEST_SIZE);
+		if (length == 0 || length > sizeof(entry) - SECRET_DIGEST_SIZE)
+			return 0;
+
+		uint64_t digest = SecretDigest(state, length, sharedSecret, sharedSecretLen);
+		memcpy(entry, &digest, sizeof(digest));
+		return Registry_publish(registry, playerID, entry, SECRET_DIGEST_SIZE + length);
+	}
+
+	int Registry_adoptPlayer(H6N_Registry* registry, H6ACTransfer* transfer, H6ACServer* server, H6N_PlayerID playerID,
+		const uint8_t* sharedSecret, unsigned int sharedSecretLen) {
+		uint8_t entry[H6N_REGISTRY_STATE_SIZE];
+		unsigned int length = Registry_lookup(registry, playerID, entry, sizeof(entry));
+
+		// State published under another secret is left for the caller that has it
+		if (length > SECRET_DIGEST_SIZE) {
+			const uint8_t* state = entry + SECRET_DIGEST_SIZE;
+			unsigned int stateLength = length - SECRET_DIGEST_SIZE;
+			uint64_t digest;
+			memcpy(&digest, entry, sizeof(digest));
+
+			if (digest == SecretDigest(state, stateLength, sharedSecret, sharedSecretLen)
+				&& transfer->importPlayer(playerID, state, stateLength)) {
+				Registry_remove(registry, playerID);
+				return 1;
+			}
+		}
+
+		server->registerPlayer(playerID, sharedSecret, sharedSecretLen);
+		return 0;
+	}
+
+}
@@ -0,0 +1,396 @@
+#include "libh6n/sessions.h"
+#include "platform.h"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+
+/*
+ * Hierarchical timer wheel
+ *
+ * Four levels of 64 slots each. Level 0 holds deadlines less than 64 ticks away, one tick per
+ * slot; each higher level covers 64 times the span of the level below it. Whenever level 0 wraps
+ * around, the next slot of level 1 is cascaded down into it, and so on up the hierarchy. Every
+ * deadline is therefore moved at most three times before it expires, and scheduling or
+ * cancelling one is a constant-time list operation.
+ *
+ * Each session owns exactly two timers (idle and attestation), so timers are addressed by
+ * session index * TIMER_KINDS + kind, and no separate timer allocation is needed.
+ *
+ * Deadlines are set from the current time, rather than from the last tick processed, so they
+ * never fire early. That is the monotonic clock, unless the tracker is driven with
+ * Session_updateAt, in which case the caller's clock is only known as of the last update.
+ *
+ * Calls into H6AC and expiry callbacks are queued while the tracker is locked and made after it
+ * is unlocked, so either may call back into the tracker. Only one thread drains the queue at a
+ * time, so the calls are made in the order they were queued, and the unregistration of an
+ * expired session can never overtake the player registering again.
+ */
+
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4
+
+// Deadlines further out than this are clamped, which is roughly 190 days at 1ms resolution
+#define WHEEL_MAX_TICKS (((uint64_t)1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1)
+
+#define TIMER_IDLE 0
+#define TIMER_ATTESTATION 1
+#define TIMER_KINDS 2
+
+#define INVALID_INDEX 0xFFFFFFFFu
+
+typedef struct {
+	uint32_t prev;
+	uint32_t next;
+	uint32_t slot;
+	uint64_t expires;
+} Timer;
+
+typedef struct {
+	H6N_PlayerID playerID;
+	Timer timers[TIMER_KINDS];
+	uint32_t nextFree;
+} Session;
+
+#define CALL_REGISTER 0
+#define CALL_UNREGISTER 1
+#define CALL_EXPIRE 2
+
+typedef struct {
+	int kind;
+	H6N_PlayerID playerID;
+	int reason;
+	// The caller's buffer is gone by the time the call is made, so the secret is copied
+	std::vector<uint8_t> sharedSecret;
+} PendingCall;
+
+struct PlayerIDHash {
+	size_t operator()(const H6N_PlayerID& id) const {
+		return (size_t)(id.of64.lo ^ (id.of64.hi * 0x9E3779B97F4A7C15ull));
+	}
+};
+
+struct _H6N_SessionTracker {
+	H6ACServer* server;
+	H6N_SessionPolicy policy;
+	Session_expiryCallback callback;
+	PlatformMutex mutex;
+
+	uint64_t createdMillis;
+
+	// Set once the caller drives the tracker with its own clock, which was last at updatedMillis
+	bool callerClock;
+	uint64_t updatedMillis;
+
+	// The next tick to be processed
+	uint64_t current;
+	uint32_t slots[WHEEL_LEVELS * WHEEL_SIZE];
+
+	std::vector<Session> sessions;
+	uint32_t freeSessions;
+	std::unordered_map<H6N_PlayerID, uint32_t, PlayerIDHash> players;
+
+	// Calls waiting to be made, and whether a thread is already making them
+	std::deque<PendingCall> calls;
+	bool draining;
+};
+
+
+static Timer& TimerAt(H6N_SessionTracker* tracker, uint32_t index) {
+	return tracker->sessions[index / TIMER_KINDS].timers[index % TIMER_KINDS];
+}
+
+static void LinkTimer(H6N_SessionTracker* tracker, uint32_t index) {
+	Timer& timer = TimerAt(tracker, index);
+	uint64_t expires = timer.expires;
+	uint64_t delta = expires - tracker->current;
+	uint32_t slot;
+
+	if (expires < tracker->current) {
+		// Already late, expire on the next tick processed
+		slot = (uint32_t)(tracker->current & WHEEL_MASK);
+	} else if (delta < ((uint64_t)1 << WHEEL_BITS)) {
+		slot = (uint32_t)(expires & WHEEL_MASK);
+	} else if (delta < ((uint64_t)1 << (WHEEL_BITS * 2))) {
+		slot = WHEEL_SIZE + (uint32_t)((expires >> WHEEL_BITS) & WHEEL_MASK);
+	} else if (delta < ((uint64_t)1 << (WHEEL_BITS * 3))) {
+		slot = WHEEL_SIZE * 2 + (uint32_t)((expires >> (WHEEL_BITS * 2)) & WHEEL_MASK);
+	} else {
+		if (delta > WHEEL_MAX_TICKS) {
+			expires = tracker->current + WHEEL_MAX_TICKS;
+			timer.expires = expires;
+		}
+		slot = WHEEL_SIZE * 3 + (uint32_t)((expires >> (WHEEL_BITS * 3)) & WHEEL_MASK);
+	}
+
+	timer.slot = slot;
+	timer.prev = INVALID_INDEX;
+	timer.next = tracker->slots[slot];
+	if (timer.next != INVALID_INDEX)
+		TimerAt(tracker, timer.next).prev = index;
+	tracker->slots[slot] = index;
+}
+
+static void UnlinkTimer(H6N_SessionTracker* tracker, uint32_t index) {
+	Timer& timer = TimerAt(tracker, index);
+	if (timer.slot == INVALID_INDEX)
+		return;
+
+	if (timer.prev != INVALID_INDEX)
+		TimerAt(tracker, timer.prev).next = timer.next;
+	else
+		tracker->slots[timer.slot] = timer.next;
+
+	if (timer.next != INVALID_INDEX)
+		TimerAt(tracker, timer.next).prev = timer.prev;
+
+	timer.slot = INVALID_INDEX;
+}
+
+static void ArmTimer(H6N_SessionTracker* tracker, uint32_t session, int kind, unsigned int timeoutMillis) {
+	uint32_t index = session * TIMER_KINDS + kind;
+	UnlinkTimer(tracker, index);
+
+	if (timeoutMillis == 0)
+		return;
+
+	uint64_t now = tracker->callerClock ? tracker->updatedMillis : Platform_tickMillis() - tracker->createdMillis;
+	uint64_t resolution = tracker->policy.resolutionMillis;
+	TimerAt(tracker, index).expires = (now + timeoutMillis + resolution - 1) / resolution;
+	LinkTimer(tracker, index);
+}
+
+// Moves every timer in a higher-level slot down to where it now belongs, returning the slot's index in its level
+static uint32_t Cascade(H6N_SessionTracker* tracker, int level) {
+	uint32_t index = (uint32_t)((tracker->current >> (WHEEL_BITS * level)) & WHEEL_MASK);
+	uint32_t slot = WHEEL_SIZE * level + index;
+
+	uint32_t timer = tracker->slots[slot];
+	tracker->slots[slot] = INVALID_INDEX;
+
+	while (timer != INVALID_INDEX) {
+		uint32_t next = TimerAt(tracker, timer).next;
+		LinkTimer(tracker, timer);
+		timer = next;
+	}
+
+	return index;
+}
+
+static void FreeSession(H6N_SessionTracker* tracker, uint32_t session) {
+	for (int kind = 0; kind < TIMER_KINDS; kind++)
+		UnlinkTimer(tracker, session * TIMER_KINDS + kind);
+
+	tracker->players.erase(tracker->sessions[session].playerID);
+	tracker->sessions[session].nextFree = tracker->freeSessions;
+	tracker->freeSessions = session;
+}
+
+static void QueueCall(H6N_SessionTracker* tracker, int kind, const H6N_PlayerID& playerID) {
+	tracker->calls.push_back(PendingCall());
+	tracker->calls.back().kind = kind;
+	tracker->calls.back().playerID = playerID;
+	tracker->calls.back().reason = 0;
+}
+
+// Makes the queued calls with the tracker unlocked. Entered locked, and returns unlocked.
+static void DrainCalls(H6N_SessionTracker* tracker) {
+	// Whoever is already draining, possibly further up this thread's stack, will make these calls too
+	if (tracker->draining) {
+		Platform_leaveMutex(&tracker->mutex);
+		return;
+	}
+	tracker->draining = true;
+
+	while (!tracker->calls.empty()) {
+		PendingCall call = std::move(tracker->calls.front());
+		tracker->calls.pop_front();
+		Session_expiryCallback callback = tracker->callback;
+		Platform_leaveMutex(&tracker->mutex);
+
+		if (call.kind == CALL_REGISTER)
+			tracker->server->registerPlayer(call.playerID, call.sharedSecret.data(), (unsigned int)call.sharedSecret.size());
+		else {
+			if (tracker->server != 0)
+				tracker->server->unregisterPlayer(call.playerID);
+			if (call.kind == CALL_EXPIRE && callback != 0)
+				callback(call.playerID, call.reason);
+		}
+
+		Platform_enterMutex(&tracker->mutex);
+	}
+
+	tracker->draining = false;
+	Platform_leaveMutex(&tracker->mutex);
+}
+
+static void ProcessTick(H6N_SessionTracker* tracker, unsigned int& expired) {
+	uint32_t index = (uint32_t)(tracker->current & WHEEL_MASK);
+
+	if (index == 0) {
+		for (int level = 1; level < WHEEL_LEVELS; level++) {
+			if (Cascade(tracker, level) != 0)
+				break;
+		}
+	}
+
+	// Freeing a session unlinks both of its timers, wherever they are, so always take from the head
+	while (tracker->slots[index] != INVALID_INDEX) {
+		uint32_t timer = tracker->slots[index];
+		uint32_t session = timer / TIMER_KINDS;
+
+		QueueCall(tracker, CALL_EXPIRE, tracker->sessions[session].playerID);
+		tracker->calls.back().reason = timer % TIMER_KINDS == TIMER_IDLE ? H6N_SESSION_EXPIRED_IDLE : H6N_SESSION_EXPIRED_ATTESTATION;
+		expired++;
+
+		FreeSession(tracker, session);
+	}
+
+	tracker->current++;
+}
+
+static unsigned int UpdateTracker(H6N_SessionTracker* tracker, uint64_t elapsedMillis) {
+	unsigned int expired = 0;
+
+	Platform_enterMutex(&tracker->mutex);
+
+	tracker->updatedMillis = elapsedMillis;
+	uint64_t target = elapsedMillis / tracker->policy.resolutionMillis;
+	while (tracker->current <= target)
+		ProcessTick(tracker, expired);
+
+	DrainCalls(tracker);
+	return expired;
+}
+
+static uint32_t FindSession(H6N_SessionTracker* tracker, const H6N_PlayerID& playerID) {
+	auto it = tracker->players.find(playerID);
+	return it != tracker->players.end() ? it->second : INVALID_INDEX;
+}
+
+
+/*
+ * Exported function implementation
+ */
+
+extern "C" {
+
+	H6N_SessionTracker* Session_createTracker(H6ACServer* server, const H6N_SessionPolicy* policy) {
+		if (policy == 0 || policy->resolutionMillis == 0)
+			return 0;
+
+		H6N_SessionTracker* tracker = new H6N_SessionTracker();
+		tracker->server = server;
+		tracker->policy = *policy;
+		tracker->callback = 0;
+		tracker->createdMillis = Platform_tickMillis();
+		tracker->callerClock = false;
+		tracker->updatedMillis = 0;
+		tracker->current = 0;
+		tracker->freeSessions = INVALID_INDEX;
+		tracker->draining = false;
+
+		for (uint32_t& slot : tracker->slots)
+			slot = INVALID_INDEX;
+
+		Platform_initMutex(&tracker->mutex);
+		return tracker;
+	}
+
+	void Session_freeTracker(H6N_SessionTracker* tracker) {
+		if (tracker == 0)
+			return;
+
+		Platform_freeMutex(&tracker->mutex);
+		delete tracker;
+	}
+
+	void Session_setExpiryCallback(H6N_SessionTracker* tracker, Session_expiryCallback callback) {
+		Platform_enterMutex(&tracker->mutex);
+		tracker->callback = callback;
+		Platform_leaveMutex(&tracker->mutex);
+	}
+
+	void Session_registerPlayer(H6N_SessionTracker* tracker, H6N_PlayerID playerID, const uint8_t* sharedSecret,
+		unsigned int sharedSecretLen) {
+		Platform_enterMutex(&tracker->mutex);
+
+		if (tracker->server != 0) {
+			QueueCall(tracker, CALL_REGISTER, playerID);
+			if (sharedSecret != 0)
+				tracker->calls.back().sharedSecret.assign(sharedSecret, sharedSecret + sharedSecretLen);
+		}
+
+		uint32_t session = FindSession(tracker, playerID);
+		if (session == INVALID_INDEX) {
+			if (tracker->freeSessions != INVALID_INDEX) {
+				session = tracker->freeSessions;
+				tracker->freeSessions = tracker->sessions[session].nextFree;
+			} else {
+				session = (uint32_t)tracker->sessions.size();
+				tracker->sessions.push_back(Session());
+			}
+
+			Session& state = tracker->sessions[session];
+			state.playerID = playerID;
+			for (Timer& timer : state.timers)
+				timer.slot = INVALID_INDEX;
+
+			tracker->players[playerID] = session;
+		}
+
+		ArmTimer(tracker, session, TIMER_IDLE, tracker->policy.idleTimeoutMillis);
+		ArmTimer(tracker, session, TIMER_ATTESTATION, tracker->policy.attestationTimeoutMillis);
+
+		DrainCalls(tracker);
+	}
+
+	void Session_unregisterPlayer(H6N_SessionTracker* tracker, H6N_PlayerID playerID) {
+		Platform_enterMutex(&tracker->mutex);
+
+		uint32_t session = FindSession(tracker, playerID);
+		if (session != INVALID_INDEX)
+			FreeSession(tracker, session);
+
+		if (tracker->server != 0)
+			QueueCall(tracker, CALL_UNREGISTER, playerID);
+
+		DrainCalls(tracker);
+	}
+
+	void Session_touch(H6N_SessionTracker* tracker, H6N_PlayerID playerID) {
+		Platform_enterMutex(&tracker->mutex);
+
+		uint32_t session = FindSession(tracker, playerID);
+		if (session != INVALID_INDEX)
+			ArmTimer(tracker, session, TIMER_IDLE, tracker->policy.idleTimeoutMillis);
+
+		Platform_leaveMutex(&tracker->mutex);
+	}
+
+	void Session_attested(H6N_SessionTracker* tracker, H6N_PlayerID playerID) {
+		Platform_enterMutex(&tracker->mutex);
+
+		uint32_t session = FindSession(tracker, playerID);
+		if (session != INVALID_INDEX)
+			ArmTimer(tracker, session, TIMER_ATTESTATION, 0);
+
+		Platform_leaveMutex(&tracker->mutex);
+	}
+
+	unsigned int Session_updateAt(H6N_SessionTracker* tracker, uint64_t elapsedMillis) {
+		Platform_enterMutex(&tracker->mutex);
+		tracker->callerClock = true;
+		Platform_leaveMutex(&tracker->mutex);
+
+		return UpdateTracker(tracker, elapsedMillis);
+	}
+
+	unsigned int Session_update(H6N_SessionTracker* tracker) {
+		return UpdateTracker(tracker, Platform_tickMillis() - tracker->createdMillis);
+	}
+
+}
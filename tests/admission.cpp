@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+#include "libh6n/admission.h"
+
+static H6N_AdmissionPolicy TestPolicy() {
+	H6N_AdmissionPolicy policy;
+	policy.ipv4PrefixLength = 24;
+	policy.ipv6PrefixLength = 64;
+	policy.burst = 2;
+	policy.refillPerSecond = 10;
+	policy.maxSubnets = 4;
+	return policy;
+}
+
+static H6N_IPV6 TestIPV6(uint8_t subnet, uint8_t host) {
+	H6N_IPV6 address = { 0 };
+	address.bytes[0] = 0x20;
+	address.bytes[1] = 0x01;
+	address.bytes[7] = subnet;
+	address.bytes[15] = host;
+	return address;
+}
+
+
+/*
+ * Regression testing for per-subnet admission control
+ */
+TEST(SDKAdmission, TestInvalidPolicy) {
+	H6N_AdmissionPolicy policy = TestPolicy();
+	policy.burst = 0;
+	EXPECT_EQ(Admission_createFilter(&policy), nullptr);
+
+	policy = TestPolicy();
+	policy.ipv4PrefixLength = 33;
+	EXPECT_EQ(Admission_createFilter(&policy), nullptr);
+
+	EXPECT_EQ(Admission_createFilter(nullptr), nullptr);
+}
+
+TEST(SDKAdmission, TestBurstThenRefill) {
+	H6N_AdmissionPolicy policy = TestPolicy();
+	H6N_AdmissionFilter* filter = Admission_createFilter(&policy);
+	H6N_IPV6 address = Admission_ipv4(192, 168, 1, 1);
+
+	EXPECT_EQ(Admission_checkAt(filter, address, 0), H6N_ADMISSION_ADMITTED);
+	EXPECT_EQ(Admission_checkAt(filter, address, 0), H6N_ADMISSION_ADMITTED);
+
+	// 10 tokens per second means one every 100ms
+	EXPECT_EQ(Admission_checkAt(filter, address, 0), 100u);
+	EXPECT_EQ(Admission_checkAt(filter, address, 60), 40u);
+	EXPECT_EQ(Admission_checkAt(filter, address, 100), H6N_ADMISSION_ADMITTED);
+
+	Admission_freeFilter(filter);
+}
+
+TEST(SDKAdmission, TestSubnetsShareBucket) {
+	H6N_AdmissionPolicy policy = TestPolicy();
+	H6N_AdmissionFilter* filter = Admission_createFilter(&policy);
+
+	EXPECT_EQ(Admission_checkAt(filter, Admission_ipv4(10, 0, 0, 1), 0), H6N_ADMISSION_ADMITTED);
+	EXPECT_EQ(Admission_checkAt(filter, Admission_ipv4(10, 0, 0, 2), 0), H6N_ADMISSION_ADMITTED);
+	EXPECT_NE(Admission_checkAt(filter, Admission_ipv4(10, 0, 0, 3), 0), H6N_ADMISSION_ADMITTED);
+
+	// Neighbouring /24 and an IPv6 /64 have their own buckets
+	EXPECT_EQ(Admission_checkAt(filter, Admission_ipv4(10, 0, 1, 1), 0), H6N_ADMISSION_ADMITTED);
+	EXPECT_EQ(Admission_checkAt(filter, TestIPV6(1, 1), 0), H6N_ADMISSION_ADMITTED);
+	EXPECT_EQ(Admission_checkAt(filter, TestIPV6(1, 2), 0), H6N_ADMISSION_ADMITTED);
+	EXPECT_NE(Admission_checkAt(filter, TestIPV6(1, 3), 0), H6N_ADMISSION_ADMITTED);
+	EXPECT_EQ(Admission_checkAt(filter, TestIPV6(2, 1), 0), H6N_ADMISSION_ADMITTED);
+
+	Admission_freeFilter(filter);
+}
+
+TEST(SDKAdmission, TestOverflowBucket) {
+	H6N_AdmissionPolicy policy = TestPolicy();
+	H6N_AdmissionFilter* filter = Admission_createFilter(&policy);
+
+	// Fill the tree with subnets that are still draining
+	for (uint8_t subnet = 0; subnet < 4; subnet++)
+		EXPECT_EQ(Admission_checkAt(filter, TestIPV6(subnet, 1), 0), H6N_ADMISSION_ADMITTED);
+
+	// Untracked subnets now drain an overflow bucket
+	EXPECT_EQ(Admission_checkAt(filter, TestIPV6(10, 1), 0), H6N_ADMISSION_ADMITTED);
+	EXPECT_EQ(Admission_checkAt(filter, TestIPV6(10, 2), 0), H6N_ADMISSION_ADMITTED);
+	EXPECT_NE(Admission_checkAt(filter, TestIPV6(10, 3), 0), H6N_ADMISSION_ADMITTED);
+
+	// A busy untracked subnet only holds up the few that share its overflow bucket
+	unsigned int admitted = 0;
+	for (uint8_t subnet = 11; subnet < 43; subnet++)
+		admitted += Admission_checkAt(filter, TestIPV6(subnet, 1), 0) == H6N_ADMISSION_ADMITTED;
+	EXPECT_GE(admitted, 24u);
+
+	// Once the tracked subnets have refilled they are pruned, and new subnets get their own buckets again
+	for (uint8_t subnet = 20; subnet < 24; subnet++) {
+		EXPECT_EQ(Admission_checkAt(filter, TestIPV6(subnet, 1), 5000), H6N_ADMISSION_ADMITTED);
+		EXPECT_EQ(Admission_checkAt(filter, TestIPV6(subnet, 2), 5000), H6N_ADMISSION_ADMITTED);
+	}
+
+	Admission_freeFilter(filter);
+}
+
+TEST(SDKAdmission, TestCallerClock) {
+	H6N_AdmissionPolicy policy = TestPolicy();
+	H6N_AdmissionFilter* filter = Admission_createFilter(&policy);
+
+	// The caller's clock starts at zero, far behind the monotonic clock
+	for (uint8_t subnet = 0; subnet < 4; subnet++)
+		EXPECT_EQ(Admission_checkAt(filter, TestIPV6(subnet, 1), 0), H6N_ADMISSION_ADMITTED);
+
+	// Too soon to prune, so untracked subnets fall into the overflow buckets, which started full
+	EXPECT_EQ(Admission_checkAt(filter, TestIPV6(10, 1), 500), H6N_ADMISSION_ADMITTED);
+	EXPECT_EQ(Admission_checkAt(filter, TestIPV6(10, 2), 500), H6N_ADMISSION_ADMITTED);
+	EXPECT_NE(Admission_checkAt(filter, TestIPV6(10, 3), 500), H6N_ADMISSION_ADMITTED);
+
+	Admission_freeFilter(filter);
+}
+
+TEST(SDKAdmission, TestManySubnets) {
+	H6N_AdmissionPolicy policy = TestPolicy();
+	policy.burst = 1;
+	policy.refillPerSecond = 0;
+	policy.maxSubnets = 1024;
+	H6N_AdmissionFilter* filter = Admission_createFilter(&policy);
+
+	for (unsigned int i = 0; i < 1000; i++)
+		EXPECT_EQ(Admission_checkAt(filter, Admission_ipv4(10, (uint8_t)(i >> 8), (uint8_t)i, 1), 0), H6N_ADMISSION_ADMITTED);
+
+	for (unsigned int i = 0; i < 1000; i++)
+		EXPECT_EQ(Admission_checkAt(filter, Admission_ipv4(10, (uint8_t)(i >> 8), (uint8_t)i, 2), 0), H6N_ADMISSION_NEVER);
+
+	Admission_freeFilter(filter);
+}
@@ -3,6 +3,12 @@
 #include "libh6n/interfaces.h"
 
 #include <libh6n/libh6n.h>
+#include "capture.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
 
 class H6NSDKEnvironment : public testing::Environment {
 public:
@@ -36,7 +42,7 @@ TEST(SDKAgent, TestNegativeInterfaceVer) {
 
 TEST(SDKAgent, TestClientCreateVer1) {
 	// Test creation
-	H6ACClient* cli = (H6ACClient*)Agent_createInterface(H6AC_CLIENT_INTERFACE, 1);
+	H6NSDK_INTERFACE(H6ACClient, 1)* cli = (H6NSDK_INTERFACE(H6ACClient, 1)*)Agent_createInterface(H6AC_CLIENT_INTERFACE, 1);
 	EXPECT_NE(cli, nullptr);
 
 	// Test that all calls don't crash
@@ -48,6 +54,20 @@ TEST(SDKAgent, TestClientCreateVer1) {
 	cli->disconnect();
 }
 
+TEST(SDKAgent, TestClientCreateVer2) {
+	// Test creation
+	H6ACClientV2* cli = (H6ACClientV2*)Agent_createInterface(H6AC_CLIENT_INTERFACE, 2);
+	ASSERT_NE(cli, nullptr);
+	if (H6N_IS_ERROR(cli))
+		GTEST_SKIP() << "The agent doesn't provide " H6AC_CLIENT_INTERFACE " version 2";
+
+	// Test that all calls don't crash
+	H6N_Int128 id = { 0x1234, 0x1234 };
+	cli->setPlayerUniqueID(id);
+	cli->submitResumptionTicket(nullptr, 0);
+	cli->disconnect();
+}
+
 TEST(SDKAgent, TestServerCreateVer1) {
 	// Test creation
 	H6ACServer* serv = (H6ACServer*)Agent_createInterface(H6AC_SERVER_INTERFACE, 1);
@@ -73,14 +93,220 @@ TEST(SDKAgent, TestReportCreateVer1) {
 	report->reportPlayer(pid, 0);
 }
 
+TEST(SDKAgent, TestTransferCreateVer1) {
+	// Test creation
+	H6ACTransfer* transfer = (H6ACTransfer*)Agent_createInterface(H6AC_TRANSFER_INTERFACE, 1);
+	ASSERT_NE(transfer, nullptr);
+	if (H6N_IS_ERROR(transfer))
+		GTEST_SKIP() << "The agent doesn't provide " H6AC_TRANSFER_INTERFACE;
+
+	// Unregistered players have no state to export or adopt
+	H6N_PlayerID pid = H6N_createInt128(0x4321);
+	uint8_t state[64];
+	EXPECT_EQ(transfer->exportPlayer(pid, state, sizeof(state)), 0u);
+	EXPECT_EQ(transfer->importPlayer(pid, state, 0), 0);
+}
+
+TEST(SDKAgent, TestTokenPoolCreateVer1) {
+	// Test creation
+	H6ACTokenPool* pool = (H6ACTokenPool*)Agent_createInterface(H6AC_TOKEN_POOL_INTERFACE, 1);
+	ASSERT_NE(pool, nullptr);
+	if (H6N_IS_ERROR(pool))
+		GTEST_SKIP() << "The agent doesn't provide " H6AC_TOKEN_POOL_INTERFACE;
+
+	// A disabled pool never generates tokens
+	pool->configure(0, 0);
+	EXPECT_EQ(pool->refill(1000), 0u);
+
+	H6N_TokenPoolMetrics metrics;
+	pool->getMetrics(&metrics);
+	EXPECT_EQ(metrics.available, 0u);
+}
+
 TEST(SDKAgent, TestClientAcquire) {
 	EXPECT_NE(Agent_createClient(), nullptr);
 }
 
+TEST(SDKAgent, TestClientAcquireVer2) {
+	H6ACClientV2* cli = Agent_createClientV2();
+	EXPECT_NE(cli, nullptr);
+	if (H6N_IS_ERROR(cli))
+		GTEST_SKIP() << "The agent doesn't provide " H6AC_CLIENT_INTERFACE " version 2";
+}
+
 TEST(SDKAgent, TestServerAcquire) {
 	EXPECT_NE(Agent_createServer(), nullptr);
 }
 
 TEST(SDKAgent, TestReportAcquire) {
 	EXPECT_NE(Agent_createReport(), nullptr);
-}
\ No newline at end of file
+}
+
+TEST(SDKAgent, TestTransferAcquire) {
+	H6ACTransfer* transfer = Agent_createTransfer();
+	EXPECT_NE(transfer, nullptr);
+	if (H6N_IS_ERROR(transfer))
+		GTEST_SKIP() << "The agent doesn't provide " H6AC_TRANSFER_INTERFACE;
+}
+
+TEST(SDKAgent, TestTokenPoolAcquire) {
+	H6ACTokenPool* pool = Agent_createTokenPool();
+	EXPECT_NE(pool, nullptr);
+	if (H6N_IS_ERROR(pool))
+		GTEST_SKIP() << "The agent doesn't provide " H6AC_TOKEN_POOL_INTERFACE;
+}
+
+TEST(SDKAgent, TestResumptionCreateVer1) {
+	// Test creation
+	H6ACResumption* resumption = (H6ACResumption*)Agent_createInterface(H6AC_RESUMPTION_INTERFACE, 1);
+	ASSERT_NE(resumption, nullptr);
+	if (H6N_IS_ERROR(resumption))
+		GTEST_SKIP() << "The agent doesn't provide " H6AC_RESUMPTION_INTERFACE;
+
+	// Unregistered players are never issued tickets, and empty tickets are never accepted
+	H6N_Int128 id = { 0x1234, 0x1234 };
+	resumption->setTicketLifetime(30);
+	EXPECT_EQ(resumption->issueTicket(id, nullptr, 0), 0u);
+	EXPECT_EQ(resumption->resumePlayer(id, nullptr, 0), 0);
+}
+
+TEST(SDKAgent, TestResumptionAcquire) {
+	H6ACResumption* resumption = Agent_createResumption();
+	EXPECT_NE(resumption, nullptr);
+	if (H6N_IS_ERROR(resumption))
+		GTEST_SKIP() << "The agent doesn't provide " H6AC_RESUMPTION_INTERFACE;
+}
+
+
+TEST(SDKAgent, TestEnumerateInterfaces) {
+	int count = Agent_enumerateInterfaces(nullptr, 0);
+	EXPECT_GE(count, 3);
+
+	H6N_InterfaceInfo infos[32];
+	EXPECT_EQ(Agent_enumerateInterfaces(infos, 32), count);
+
+	// Every enumerated interface must be creatable at its maximum version
+	for (int i = 0; i < count && i < 32; i++) {
+		void* iface = Agent_createInterface(infos[i].name, infos[i].maxVersion);
+		EXPECT_NE(iface, nullptr);
+		EXPECT_TRUE(H6N_NO_ERROR(iface));
+	}
+}
+
+TEST(SDKAgent, TestCreateInterfaces) {
+	H6N_InterfaceRequest requests[] = {
+		{ H6AC_CLIENT_INTERFACE, H6AC_CLIENT_VERSION, nullptr },
+		{ H6AC_SERVER_INTERFACE, H6AC_SERVER_VERSION, nullptr },
+		{ "DoesNotExist", 1, nullptr },
+		{ H6AC_REPORT_INTERFACE, H6AC_REPORT_VERSION, nullptr },
+	};
+
+	EXPECT_EQ(Agent_createInterfaces(requests, 4), 3);
+	EXPECT_EQ(requests[0].result, Agent_createInterface(H6AC_CLIENT_INTERFACE, H6AC_CLIENT_VERSION));
+	EXPECT_EQ(requests[1].result, Agent_createInterface(H6AC_SERVER_INTERFACE, H6AC_SERVER_VERSION));
+	EXPECT_EQ(requests[2].result, H6N_ERROR_INTERFACE_NOT_FOUND);
+	EXPECT_EQ(requests[3].result, Agent_createInterface(H6AC_REPORT_INTERFACE, H6AC_REPORT_VERSION));
+}
+
+TEST(SDKAgent, TestCapture) {
+	EXPECT_EQ(H6N_beginCapture("libh6nTest.capture", 1 << 16), 1);
+	EXPECT_EQ(H6N_beginCapture("libh6nTest.capture", 1 << 16), 0);
+
+	// Captured interfaces must still forward every call to the agent
+	H6ACServer* serv = Agent_createServer();
+	H6ACClient* cli = Agent_createClient();
+	H6ACReport* report = Agent_createReport();
+	EXPECT_TRUE(serv != nullptr && H6N_NO_ERROR(serv));
+	EXPECT_TRUE(cli != nullptr && H6N_NO_ERROR(cli));
+	EXPECT_TRUE(report != nullptr && H6N_NO_ERROR(report));
+
+	H6N_PlayerID pid = H6N_createInt128(0x1234);
+	uint8_t secret[4] = { 1, 2, 3, 4 };
+	std::vector<uint16_t> expected;
+	if (H6N_NO_ERROR(serv) && H6N_NO_ERROR(cli) && H6N_NO_ERROR(report)) {
+		serv->begin(H6N_createInt128(1));
+		serv->registerPlayer(pid, secret, sizeof(secret));
+		cli->setPlayerUniqueID(pid);
+		cli->setSharedSecret(secret, sizeof(secret));
+		cli->submitClientAttestation(secret, sizeof(secret));
+		report->reportPlayer(pid, 0);
+		cli->disconnect();
+		serv->unregisterPlayer(pid);
+		serv->end();
+
+		expected = {
+			CAPTURE_SERVER_BEGIN,
+			CAPTURE_SERVER_REGISTER,
+			CAPTURE_CLIENT_PLAYER_ID,
+			CAPTURE_CLIENT_SECRET,
+			CAPTURE_CLIENT_ATTESTATION,
+			CAPTURE_REPORT_PLAYER,
+			CAPTURE_CLIENT_DISCONNECT,
+			CAPTURE_SERVER_UNREGISTER,
+			CAPTURE_SERVER_END,
+		};
+	}
+
+	// Interfaces newer than the agent may be missing, in which case there's nothing to capture
+	H6ACClientV2* cliV2 = Agent_createClientV2();
+	if (cliV2 != nullptr && H6N_NO_ERROR(cliV2)) {
+		cliV2->submitResumptionTicket(secret, sizeof(secret));
+		expected.push_back(CAPTURE_CLIENT_RESUME);
+	}
+
+	H6ACTransfer* transfer = Agent_createTransfer();
+	int imported = -1;
+	if (transfer != nullptr && H6N_NO_ERROR(transfer)) {
+		imported = transfer->importPlayer(pid, secret, sizeof(secret));
+		expected.push_back(CAPTURE_TRANSFER_IMPORT);
+	}
+
+	H6ACResumption* resumption = Agent_createResumption();
+	if (resumption != nullptr && H6N_NO_ERROR(resumption)) {
+		resumption->resumePlayer(pid, secret, sizeof(secret));
+		expected.push_back(CAPTURE_RESUMPTION_RESUME);
+	}
+
+	H6N_endCapture();
+
+	FILE* capture = fopen("libh6nTest.capture", "rb");
+	ASSERT_NE(capture, nullptr);
+	std::vector<uint8_t> data(1 << 16);
+	data.resize(fread(data.data(), 1, data.size(), capture));
+	fclose(capture);
+	remove("libh6nTest.capture");
+
+	// The file is trimmed to the records written
+	EXPECT_LT(data.size(), (size_t)(1 << 16));
+
+	CaptureHeader header;
+	ASSERT_GE(data.size(), sizeof(header));
+	memcpy(&header, data.data(), sizeof(header));
+	EXPECT_EQ(header.magic, CAPTURE_MAGIC);
+	EXPECT_EQ(header.version, (uint32_t)CAPTURE_VERSION);
+
+	std::vector<uint16_t> types;
+	size_t offset = sizeof(header);
+	while (offset + sizeof(CaptureRecord) <= data.size()) {
+		CaptureRecord record;
+		memcpy(&record, data.data() + offset, sizeof(record));
+		if (record.type == CAPTURE_NONE)
+			break;
+
+		// Imports are recorded with their result, as replays can't reproduce it
+		if (record.type == CAPTURE_TRANSFER_IMPORT) {
+			int32_t result;
+			ASSERT_EQ(record.length, sizeof(H6N_PlayerID) + 2 * sizeof(uint32_t));
+			memcpy(&result, data.data() + offset + sizeof(record) + sizeof(H6N_PlayerID) + sizeof(uint32_t), sizeof(result));
+			EXPECT_EQ(result, imported);
+		}
+
+		types.push_back(record.type);
+		offset += sizeof(record) + ((record.length + CAPTURE_ALIGN - 1) & ~(size_t)(CAPTURE_ALIGN - 1));
+	}
+	EXPECT_LE(offset, data.size());
+	EXPECT_EQ(types, expected);
+
+	// Secrets, tickets and transferred state are never written, only their lengths
+	EXPECT_EQ(std::search(data.begin(), data.end(), secret, secret + sizeof(secret)), data.end());
+}
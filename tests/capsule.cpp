@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include "libh6n/capsule.h"
+
+#include <string>
+#include <string.h>
+
+
+/*
+ * Regression testing for argument flattening
+ */
+TEST(SDKCapsule, TestFlattenPlain) {
+	char* argv[] = { (char*)"game.exe", (char*)"-windowed", (char*)"+map", (char*)"de_dust2" };
+	char arena[64];
+
+	EXPECT_EQ(Capsule_flattenArgsInto(4, argv, arena, sizeof(arena)), 24u);
+	EXPECT_STREQ(arena, "-windowed +map de_dust2");
+
+	// Only the executable, so there's nothing to flatten
+	EXPECT_EQ(Capsule_flattenArgsInto(1, argv, arena, sizeof(arena)), 1u);
+	EXPECT_STREQ(arena, "");
+}
+
+TEST(SDKCapsule, TestFlattenQuoting) {
+	char* argv[] = {
+		(char*)"game.exe",
+		(char*)"two words",
+		(char*)"",
+		(char*)"say \"hi\"",
+		(char*)"C:\\Mods Folder\\",
+		(char*)"a\\\\b",
+	};
+	char arena[128];
+
+	unsigned int length = Capsule_flattenArgsInto(6, argv, arena, sizeof(arena));
+	EXPECT_STREQ(arena, "\"two words\" \"\" \"say \\\"hi\\\"\" \"C:\\Mods Folder\\\\\" a\\\\b");
+	EXPECT_EQ(length, strlen(arena) + 1);
+}
+
+TEST(SDKCapsule, TestFlattenArenaTooSmall) {
+	char* argv[] = { (char*)"game.exe", (char*)"-windowed", (char*)"two words" };
+	char arena[8];
+
+	unsigned int needed = Capsule_flattenArgsInto(3, argv, 0, 0);
+	EXPECT_EQ(needed, 22u);
+
+	// The arena is left empty rather than holding a truncated argument list
+	EXPECT_EQ(Capsule_flattenArgsInto(3, argv, arena, sizeof(arena)), needed);
+	EXPECT_STREQ(arena, "");
+}
+
+TEST(SDKCapsule, TestFlattenAlignment) {
+	// Arguments at every alignment, long enough to span several blocks, with the space in each block position
+	char buffer[128];
+	for (int offset = 0; offset < 16; offset++) {
+		for (int space = 0; space < 47; space++) {
+			memset(buffer, 'x', sizeof(buffer));
+			buffer[offset + space] = ' ';
+			buffer[offset + 48] = 0;
+
+			char* argv[] = { (char*)"game.exe", buffer + offset, buffer + offset + space + 1 };
+			std::string expected = "\"" + std::string(buffer + offset) + "\" " + std::string(buffer + offset + space + 1);
+
+			char arena[128];
+			EXPECT_EQ(Capsule_flattenArgsInto(3, argv, arena, sizeof(arena)), expected.size() + 1);
+			EXPECT_EQ(expected, arena);
+		}
+	}
+}
@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+#include "libh6n/channel.h"
+#include "platform.h"
+
+#include <atomic>
+#include <string.h>
+#include <thread>
+
+
+// A capsule that only keeps hold of its callbacks, so tests can call them like the real one would
+static Capsule_progressCallback CapsuleProgress = nullptr;
+
+static long TestLaunch(const char*, H6N_IntegrationID, char*) {
+	return H6N_CAPSULE_RESULT_SUCCESS;
+}
+
+static long TestLaunchv(const char*, H6N_IntegrationID, int, char**) {
+	return H6N_CAPSULE_RESULT_SUCCESS;
+}
+
+static void TestErrorCallback(Capsule_errorCallback) {
+}
+
+static void TestProgressCallback(Capsule_progressCallback callback) {
+	CapsuleProgress = callback;
+}
+
+static H6Capsule TestCapsule = { TestLaunch, TestErrorCallback, TestProgressCallback, TestLaunchv };
+
+
+/*
+ * Regression testing for the launcher channel
+ */
+TEST(SDKChannel, TestOpenWithoutLauncher) {
+	H6N_Channel* channel = Channel_create(256);
+	ASSERT_NE(channel, nullptr);
+	Channel_close(channel);
+
+	// The launcher's end is gone, so there is nothing left to open
+	EXPECT_EQ(Channel_open(), nullptr);
+}
+
+TEST(SDKChannel, TestRoundTrip) {
+	H6N_Channel* launcher = Channel_create(256);
+	H6N_Channel* game = Channel_open();
+	ASSERT_NE(launcher, nullptr);
+	ASSERT_NE(game, nullptr);
+
+	H6N_IntegrationID id = H6N_createInt128(0x1234, 0x5678);
+	EXPECT_EQ(Channel_write(launcher, H6N_CHANNEL_INTEGRATION_ID, &id, sizeof(id)), 1);
+	EXPECT_EQ(Channel_write(launcher, H6N_CHANNEL_ERROR, "oops", 5), 1);
+
+	unsigned int type;
+	H6N_IntegrationID readID;
+	unsigned int length = sizeof(readID);
+	EXPECT_EQ(Channel_read(game, &type, &readID, &length), H6N_CHANNEL_READ);
+	EXPECT_EQ(type, (unsigned int)H6N_CHANNEL_INTEGRATION_ID);
+	EXPECT_EQ(length, sizeof(readID));
+	EXPECT_EQ(readID, id);
+
+	char message[2];
+	length = sizeof(message);
+	EXPECT_EQ(Channel_read(game, &type, message, &length), H6N_CHANNEL_TOO_SMALL);
+	EXPECT_EQ(length, 5u);
+
+	char bigger[16];
+	EXPECT_EQ(Channel_read(game, &type, bigger, &length), H6N_CHANNEL_READ);
+	EXPECT_EQ(type, (unsigned int)H6N_CHANNEL_ERROR);
+	EXPECT_STREQ(bigger, "oops");
+
+	EXPECT_EQ(Channel_read(game, &type, bigger, &length), H6N_CHANNEL_EMPTY);
+
+	Channel_close(game);
+	Channel_close(launcher);
+}
+
+TEST(SDKChannel, TestFullAndWrap) {
+	H6N_Channel* launcher = Channel_create(64);
+	H6N_Channel* game = Channel_open();
+	ASSERT_NE(game, nullptr);
+
+	uint8_t payload[20];
+	uint8_t out[20];
+	unsigned int type, length;
+
+	// Each message takes 32 bytes of ring, so only two fit at a time
+	for (int round = 0; round < 10; round++) {
+		memset(payload, round, sizeof(payload));
+		EXPECT_EQ(Channel_write(launcher, H6N_CHANNEL_USER, payload, sizeof(payload)), 1);
+		EXPECT_EQ(Channel_write(launcher, H6N_CHANNEL_USER, payload, sizeof(payload)), 1);
+		EXPECT_EQ(Channel_write(launcher, H6N_CHANNEL_USER, payload, sizeof(payload)), 0);
+
+		for (int i = 0; i < 2; i++) {
+			length = sizeof(out);
+			EXPECT_EQ(Channel_read(game, &type, out, &length), H6N_CHANNEL_READ);
+			EXPECT_EQ(memcmp(out, payload, sizeof(out)), 0);
+		}
+	}
+
+	Channel_close(game);
+	Channel_close(launcher);
+}
+
+TEST(SDKChannel, TestCorruptLength) {
+	H6N_Channel* launcher = Channel_create(64);
+	H6N_Channel* game = Channel_open();
+	ASSERT_NE(game, nullptr);
+
+	uint32_t payload = 0;
+	EXPECT_EQ(Channel_write(launcher, H6N_CHANNEL_USER + 0x1234, &payload, sizeof(payload)), 1);
+
+	// Find the message through a mapping of our own, as another process could, covering the header's few cache lines
+	// and the ring after them
+	char name[64];
+	ASSERT_TRUE(Platform_getEnvironment(H6N_CHANNEL_ENVIRONMENT, name, sizeof(name)));
+	PlatformSharedMemory memory;
+	ASSERT_TRUE(Platform_openSharedMemory(&memory, name, 256, 0));
+
+	uint32_t header[2] = { H6N_CHANNEL_USER + 0x1234, sizeof(payload) };
+	uint8_t* found = nullptr;
+	for (size_t offset = 0; offset + sizeof(header) <= memory.size && found == nullptr; offset += 8) {
+		if (memcmp((uint8_t*)memory.base + offset, header, sizeof(header)) == 0)
+			found = (uint8_t*)memory.base + offset;
+	}
+	ASSERT_NE(found, nullptr);
+
+	// Lengths beyond the ring, or beyond what has been written, must not be read
+	uint32_t lengths[] = { 0xFFFFFFF0u, 200, 40 };
+	uint8_t out[256];
+	for (uint32_t length : lengths) {
+		memcpy(found + sizeof(uint32_t), &length, sizeof(length));
+
+		unsigned int type, outLength = sizeof(out);
+		EXPECT_EQ(Channel_read(game, &type, out, &outLength), H6N_CHANNEL_CORRUPT);
+	}
+
+	Platform_freeSharedMemory(&memory);
+	Channel_close(game);
+	Channel_close(launcher);
+}
+
+TEST(SDKChannel, TestCloseWhileForwarding) {
+	H6N_Channel* launcher;
+	EXPECT_EQ(Capsule_launchWithChannel(&TestCapsule, "game", H6N_createInt128(1), (char*)"", nullptr, nullptr,
+		&launcher), H6N_CAPSULE_RESULT_SUCCESS);
+	ASSERT_NE(launcher, nullptr);
+	ASSERT_NE(CapsuleProgress, nullptr);
+
+	// The capsule reports progress from its own thread while the launcher closes the channel
+	std::atomic<bool> started(false);
+	std::thread capsule([&] {
+		for (int i = 0; i < 100000; i++) {
+			CapsuleProgress(i / 100000.0f);
+			started = true;
+		}
+	});
+
+	while (!started)
+		std::this_thread::yield();
+	Channel_close(launcher);
+	capsule.join();
+
+	// Once closed, the channel is no longer advertised to processes launched afterwards
+	EXPECT_EQ(Channel_open(), nullptr);
+}
@@ -0,0 +1,219 @@
+#include "gtest/gtest.h"
+#include "libh6n/registry.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+#  include <signal.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+
+// Starts each test from a fresh registry, whatever an earlier run left behind
+static H6N_Registry* OpenTestRegistry(const char* name, unsigned int capacity, unsigned int ttlMillis) {
+	Registry_unlink(name);
+	return Registry_open(name, capacity, ttlMillis);
+}
+
+// Stands in for H6AC, exporting a fixed state and recording how players were registered
+static const uint8_t exportedState[] = { 4, 3, 2, 1 };
+static int imports, registrations;
+
+static unsigned int TransferExport(H6N_PlayerID, uint8_t* out, unsigned int outLength) {
+	if (outLength < sizeof(exportedState))
+		return 0;
+	memcpy(out, exportedState, sizeof(exportedState));
+	return sizeof(exportedState);
+}
+
+static int TransferImport(H6N_PlayerID, const uint8_t* state, unsigned int length) {
+	imports++;
+	return length == sizeof(exportedState) && memcmp(state, exportedState, length) == 0;
+}
+
+static H6ACTransfer TestTransfer = {
+	TransferExport,
+	TransferImport,
+};
+
+static void ServerBegin(H6N_IntegrationID) {}
+static void ServerEnd() {}
+static void ServerRegister(H6N_PlayerID, const uint8_t*, unsigned int) { registrations++; }
+static void ServerUnregister(H6N_PlayerID) {}
+static void ServerSetKickCallback(H6NSDK_INTERFACE(H6ACServer_kickCallback, 1)) {}
+static void ServerSetAttestationCallback(H6NSDK_INTERFACE(H6ACServer_attestationCallback, 1)) {}
+static void ServerSetUpdateCallback(H6NSDK_INTERFACE(H6ACServer_updateCallback, 1)) {}
+
+static H6ACServer TestServer = {
+	ServerBegin,
+	ServerEnd,
+	ServerRegister,
+	ServerUnregister,
+	ServerSetKickCallback,
+	ServerSetAttestationCallback,
+	ServerSetUpdateCallback,
+};
+
+
+/*
+ * Regression testing for the shared player registry
+ */
+TEST(SDKRegistry, TestPublishLookupRemove) {
+	H6N_Registry* publisher = OpenTestRegistry("libh6nTest-publish", 64, 60000);
+	H6N_Registry* adopter = Registry_open("libh6nTest-publish", 64, 60000);
+	ASSERT_NE(publisher, nullptr);
+	ASSERT_NE(adopter, nullptr);
+
+	H6N_PlayerID id = H6N_createInt128(0x1234, 0x5678);
+	const uint8_t state[] = { 1, 2, 3, 4, 5 };
+	EXPECT_EQ(Registry_publish(publisher, id, state, sizeof(state)), 1);
+
+	// A second handle to the registry sees the same players
+	uint8_t out[H6N_REGISTRY_STATE_SIZE];
+	EXPECT_EQ(Registry_lookup(adopter, id, out, sizeof(out)), sizeof(state));
+	EXPECT_EQ(memcmp(out, state, sizeof(state)), 0);
+
+	// Republishing replaces the state in place
+	const uint8_t newer[] = { 9, 8, 7 };
+	EXPECT_EQ(Registry_publish(publisher, id, newer, sizeof(newer)), 1);
+	EXPECT_EQ(Registry_lookup(adopter, id, out, sizeof(out)), sizeof(newer));
+	EXPECT_EQ(memcmp(out, newer, sizeof(newer)), 0);
+
+	// Too small an output buffer is a miss
+	EXPECT_EQ(Registry_lookup(adopter, id, out, 2), 0u);
+
+	Registry_remove(adopter, id);
+	EXPECT_EQ(Registry_lookup(publisher, id, out, sizeof(out)), 0u);
+
+	Registry_close(adopter);
+	Registry_close(publisher);
+	Registry_unlink("libh6nTest-publish");
+}
+
+TEST(SDKRegistry, TestCapacityMismatch) {
+	H6N_Registry* registry = OpenTestRegistry("libh6nTest-capacity", 16, 60000);
+	ASSERT_NE(registry, nullptr);
+	EXPECT_EQ(Registry_open("libh6nTest-capacity", 32, 60000), nullptr);
+	Registry_close(registry);
+	Registry_unlink("libh6nTest-capacity");
+}
+
+TEST(SDKRegistry, TestNameTooLong) {
+	// Names that would be cut short could open another registry's region, so they're refused instead
+	char name[H6N_REGISTRY_MAX_NAME + 2];
+	memset(name, 'x', sizeof(name) - 1);
+	name[sizeof(name) - 1] = 0;
+	EXPECT_EQ(Registry_open(name, 16, 60000), nullptr);
+
+	name[H6N_REGISTRY_MAX_NAME] = 0;
+	H6N_Registry* registry = OpenTestRegistry(name, 16, 60000);
+	EXPECT_NE(registry, nullptr);
+	Registry_close(registry);
+	Registry_unlink(name);
+}
+
+TEST(SDKRegistry, TestAdoptRequiresSecret) {
+	H6N_Registry* registry = OpenTestRegistry("libh6nTest-adopt", 16, 60000);
+	ASSERT_NE(registry, nullptr);
+
+	H6N_PlayerID id = H6N_createInt128(0x4242);
+	const uint8_t secret[] = { 's', 'e', 'c', 'r', 'e', 't' };
+	const uint8_t other[] = { 'o', 't', 'h', 'e', 'r' };
+	imports = registrations = 0;
+
+	// State published under one secret isn't adopted under another, and stays for the player's rightful owner
+	ASSERT_EQ(Registry_publishPlayer(registry, &TestTransfer, id, secret, sizeof(secret)), 1);
+	EXPECT_EQ(Registry_adoptPlayer(registry, &TestTransfer, &TestServer, id, other, sizeof(other)), 0);
+	EXPECT_EQ(imports, 0);
+	EXPECT_EQ(registrations, 1);
+
+	EXPECT_EQ(Registry_adoptPlayer(registry, &TestTransfer, &TestServer, id, secret, sizeof(secret)), 1);
+	EXPECT_EQ(imports, 1);
+	EXPECT_EQ(registrations, 1);
+
+	// Adopted state is withdrawn
+	EXPECT_EQ(Registry_adoptPlayer(registry, &TestTransfer, &TestServer, id, secret, sizeof(secret)), 0);
+	EXPECT_EQ(registrations, 2);
+
+	Registry_close(registry);
+	Registry_unlink("libh6nTest-adopt");
+}
+
+TEST(SDKRegistry, TestExpiredSlotsReused) {
+	// Entries expire immediately, so every slot is always up for reuse
+	H6N_Registry* registry = OpenTestRegistry("libh6nTest-expiry", 4, 0);
+	ASSERT_NE(registry, nullptr);
+
+	const uint8_t state[] = { 1 };
+	uint8_t out[H6N_REGISTRY_STATE_SIZE];
+	for (uint64_t i = 0; i < 64; i++) {
+		EXPECT_EQ(Registry_publish(registry, H6N_createInt128(i), state, sizeof(state)), 1);
+		EXPECT_EQ(Registry_lookup(registry, H6N_createInt128(i), out, sizeof(out)), 0u);
+	}
+
+	// Oversized state is refused outright
+	uint8_t large[H6N_REGISTRY_STATE_SIZE + 1] = { 0 };
+	EXPECT_EQ(Registry_publish(registry, H6N_createInt128(1), large, sizeof(large)), 0);
+
+	Registry_close(registry);
+	Registry_unlink("libh6nTest-expiry");
+}
+
+TEST(SDKRegistry, TestChurn) {
+	H6N_Registry* registry = OpenTestRegistry("libh6nTest-churn", 256, 60000);
+	ASSERT_NE(registry, nullptr);
+
+	// Keep a sliding window of players published, so every slot is used many times over
+	const uint64_t window = 128;
+	const uint8_t state[] = { 1 };
+	uint8_t out[H6N_REGISTRY_STATE_SIZE];
+	for (uint64_t i = 0; i < 256 * 16; i++) {
+		EXPECT_EQ(Registry_publish(registry, H6N_createInt128(i), state, sizeof(state)), 1);
+		if (i >= window)
+			Registry_remove(registry, H6N_createInt128(i - window));
+	}
+
+	// Players still published are found wherever they ended up, and withdrawn ones aren't
+	for (uint64_t i = 0; i < 256 * 16; i++) {
+		unsigned int expected = i >= 256 * 16 - window ? sizeof(state) : 0u;
+		EXPECT_EQ(Registry_lookup(registry, H6N_createInt128(i), out, sizeof(out)), expected);
+	}
+
+	Registry_close(registry);
+	Registry_unlink("libh6nTest-churn");
+}
+
+#ifndef _WIN32
+TEST(SDKRegistry, TestWriterKilled) {
+	H6N_Registry* registry = OpenTestRegistry("libh6nTest-killed", 4, 60000);
+	ASSERT_NE(registry, nullptr);
+
+	// Kill writers at random points, some of them while they hold a slot
+	for (int round = 0; round < 20; round++) {
+		pid_t child = fork();
+		ASSERT_GE(child, 0);
+		if (child == 0) {
+			H6N_Registry* writer = Registry_open("libh6nTest-killed", 4, 60000);
+			const uint8_t state[H6N_REGISTRY_STATE_SIZE] = { 0 };
+			for (uint64_t i = 0;; i++)
+				Registry_publish(writer, H6N_createInt128(i % 4), state, sizeof(state));
+		}
+
+		usleep(1000 + round * 100);
+		kill(child, SIGKILL);
+		waitpid(child, 0, 0);
+	}
+
+	// Slots abandoned mid-write are taken over, so publishing and looking up still work
+	const uint8_t state[] = { 7 };
+	uint8_t out[H6N_REGISTRY_STATE_SIZE];
+	for (uint64_t i = 0; i < 4; i++) {
+		H6N_PlayerID id = H6N_createInt128(i);
+		EXPECT_EQ(Registry_publish(registry, id, state, sizeof(state)), 1);
+		EXPECT_EQ(Registry_lookup(registry, id, out, sizeof(out)), sizeof(state));
+	}
+
+	Registry_close(registry);
+	Registry_unlink("libh6nTest-killed");
+}
+#endif
@@ -0,0 +1,186 @@
+#include "gtest/gtest.h"
+#include "libh6n/sessions.h"
+
+#include <vector>
+
+static std::vector<std::pair<H6N_PlayerID, int>> expirations;
+
+static void RecordExpiry(H6N_PlayerID playerID, int reason) {
+	expirations.push_back(std::make_pair(playerID, reason));
+}
+
+// Records the calls a tracker makes into H6AC, and calls back into the tracker from them as H6AC callbacks may
+static H6N_SessionTracker* serverTracker;
+static std::vector<std::pair<H6N_PlayerID, bool>> serverCalls;
+
+static void ServerBegin(H6N_IntegrationID) {}
+static void ServerEnd() {}
+static void ServerSetKickCallback(H6NSDK_INTERFACE(H6ACServer_kickCallback, 1)) {}
+static void ServerSetAttestationCallback(H6NSDK_INTERFACE(H6ACServer_attestationCallback, 1)) {}
+static void ServerSetUpdateCallback(H6NSDK_INTERFACE(H6ACServer_updateCallback, 1)) {}
+
+static void ServerRegister(H6N_PlayerID playerID, const uint8_t*, unsigned int) {
+	serverCalls.push_back(std::make_pair(playerID, true));
+	Session_attested(serverTracker, playerID);
+}
+
+static void ServerUnregister(H6N_PlayerID playerID) {
+	serverCalls.push_back(std::make_pair(playerID, false));
+	Session_touch(serverTracker, playerID);
+}
+
+static H6ACServer TestServer = {
+	ServerBegin,
+	ServerEnd,
+	ServerRegister,
+	ServerUnregister,
+	ServerSetKickCallback,
+	ServerSetAttestationCallback,
+	ServerSetUpdateCallback,
+};
+
+static void RegisterAgain(H6N_PlayerID playerID, int reason) {
+	RecordExpiry(playerID, reason);
+	Session_registerPlayer(serverTracker, playerID, nullptr, 0);
+}
+
+static H6N_SessionTracker* CreateTestTracker() {
+	H6N_SessionPolicy policy;
+	policy.idleTimeoutMillis = 1000;
+	policy.attestationTimeoutMillis = 300;
+	policy.resolutionMillis = 10;
+
+	H6N_SessionTracker* tracker = Session_createTracker(nullptr, &policy);
+	Session_setExpiryCallback(tracker, RecordExpiry);
+	Session_updateAt(tracker, 0);
+	expirations.clear();
+	return tracker;
+}
+
+
+/*
+ * Regression testing for session deadlines
+ */
+TEST(SDKSessions, TestInvalidPolicy) {
+	H6N_SessionPolicy policy = { 1000, 1000, 0 };
+	EXPECT_EQ(Session_createTracker(nullptr, &policy), nullptr);
+}
+
+TEST(SDKSessions, TestAttestationDeadline) {
+	H6N_SessionTracker* tracker = CreateTestTracker();
+	H6N_PlayerID id = H6N_createInt128(1);
+
+	Session_registerPlayer(tracker, id, nullptr, 0);
+	EXPECT_EQ(Session_updateAt(tracker, 290), 0u);
+	EXPECT_EQ(Session_updateAt(tracker, 300), 1u);
+
+	ASSERT_EQ(expirations.size(), 1u);
+	EXPECT_EQ(expirations[0].first, id);
+	EXPECT_EQ(expirations[0].second, H6N_SESSION_EXPIRED_ATTESTATION);
+
+	// The session is gone, so the idle deadline must not fire later
+	EXPECT_EQ(Session_updateAt(tracker, 5000), 0u);
+
+	Session_freeTracker(tracker);
+}
+
+TEST(SDKSessions, TestIdleDeadline) {
+	H6N_SessionTracker* tracker = CreateTestTracker();
+	H6N_PlayerID id = H6N_createInt128(2);
+
+	Session_registerPlayer(tracker, id, nullptr, 0);
+	Session_attested(tracker, id);
+
+	// Touching the session pushes the idle deadline out
+	EXPECT_EQ(Session_updateAt(tracker, 900), 0u);
+	Session_touch(tracker, id);
+	EXPECT_EQ(Session_updateAt(tracker, 1500), 0u);
+	EXPECT_EQ(Session_updateAt(tracker, 1920), 1u);
+
+	ASSERT_EQ(expirations.size(), 1u);
+	EXPECT_EQ(expirations[0].second, H6N_SESSION_EXPIRED_IDLE);
+
+	Session_freeTracker(tracker);
+}
+
+TEST(SDKSessions, TestDeadlinesFromLastUpdate) {
+	H6N_SessionTracker* tracker = CreateTestTracker();
+	H6N_PlayerID id = H6N_createInt128(4);
+
+	// Deadlines start from the most recent update, not from the last tick processed before it
+	EXPECT_EQ(Session_updateAt(tracker, 905), 0u);
+	Session_registerPlayer(tracker, id, nullptr, 0);
+	Session_attested(tracker, id);
+
+	EXPECT_EQ(Session_updateAt(tracker, 1900), 0u);
+	EXPECT_EQ(Session_updateAt(tracker, 1910), 1u);
+
+	Session_freeTracker(tracker);
+}
+
+TEST(SDKSessions, TestCallbacksReenter) {
+	H6N_SessionPolicy policy;
+	policy.idleTimeoutMillis = 1000;
+	policy.attestationTimeoutMillis = 300;
+	policy.resolutionMillis = 10;
+
+	serverTracker = Session_createTracker(&TestServer, &policy);
+	Session_setExpiryCallback(serverTracker, RegisterAgain);
+	Session_updateAt(serverTracker, 0);
+	expirations.clear();
+	serverCalls.clear();
+
+	// The server calls back into the tracker from registerPlayer, which attests the player
+	H6N_PlayerID id = H6N_createInt128(6);
+	Session_registerPlayer(serverTracker, id, nullptr, 0);
+	EXPECT_EQ(Session_updateAt(serverTracker, 500), 0u);
+
+	// The expiry callback registers the player again, which must reach H6AC after the expiry's unregistration
+	EXPECT_EQ(Session_updateAt(serverTracker, 1000), 1u);
+	ASSERT_EQ(expirations.size(), 1u);
+	EXPECT_EQ(expirations[0].second, H6N_SESSION_EXPIRED_IDLE);
+
+	ASSERT_EQ(serverCalls.size(), 3u);
+	EXPECT_TRUE(serverCalls[0].second);
+	EXPECT_FALSE(serverCalls[1].second);
+	EXPECT_TRUE(serverCalls[2].second);
+
+	Session_freeTracker(serverTracker);
+}
+
+TEST(SDKSessions, TestUnregisterCancels) {
+	H6N_SessionTracker* tracker = CreateTestTracker();
+	H6N_PlayerID id = H6N_createInt128(3);
+
+	Session_registerPlayer(tracker, id, nullptr, 0);
+	Session_unregisterPlayer(tracker, id);
+	EXPECT_EQ(Session_updateAt(tracker, 5000), 0u);
+
+	Session_freeTracker(tracker);
+}
+
+TEST(SDKSessions, TestLongDeadlinesCascade) {
+	H6N_SessionPolicy policy;
+	policy.idleTimeoutMillis = 3600 * 1000;
+	policy.attestationTimeoutMillis = 0;
+	policy.resolutionMillis = 1;
+
+	H6N_SessionTracker* tracker = Session_createTracker(nullptr, &policy);
+	Session_setExpiryCallback(tracker, RecordExpiry);
+	expirations.clear();
+
+	// Stagger deadlines so they land in every level of the wheel
+	for (uint64_t i = 0; i < 1000; i++) {
+		Session_updateAt(tracker, i * 37);
+		Session_registerPlayer(tracker, H6N_createInt128(i), nullptr, 0);
+	}
+
+	EXPECT_EQ(Session_updateAt(tracker, 3600 * 1000 - 1), 0u);
+	EXPECT_EQ(Session_updateAt(tracker, 3600 * 1000 + 999 * 37 + 1), 1000u);
+
+	// Deadlines expire in the order they were scheduled
+	for (uint64_t i = 0; i < 1000; i++)
+		EXPECT_EQ(expirations[i].first, H6N_createInt128(i));
+
+	Session_freeTracker(tracker);
+}
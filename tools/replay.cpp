@@ -0,0 +1,437 @@
+/*
+ * h6nreplay
+ *
+ * Replays a call capture made with H6N_beginCapture against the H6N agent, to reproduce
+ * production load offline. Calls are replayed with their recorded timing, optionally sped up,
+ * and spread across worker threads so that related calls stay in order: server calls about a
+ * player go to a thread picked by player ID, and client calls, which carry no player ID of their
+ * own, all go to the same thread. Server begin and end calls, and changes to the ticket lifetime,
+ * are barriers; every call recorded before one has been replayed by the time it is, and none
+ * recorded after it has started. Callbacks in the capture aren't replayed, as they are the
+ * agent's output; instead, the callbacks made during the replay are counted and compared
+ * against the recorded ones.
+ *
+ * Calls to interfaces the agent doesn't provide, such as resumption tickets on agents that only
+ * offer version 1 of H6ACClient, are skipped and counted separately. So are imports of transferred
+ * state and resumptions from tickets: the state and tickets aren't captured, and the agent would
+ * reject every stand-in for them. Where the captured call was rejected, the registration the game
+ * fell back to was captured in its own right and is replayed as usual.
+ *
+ * Usage: h6nreplay <capture file> [-speed <factor>] [-threads <count>]
+ */
+
+#include "libh6n/libh6n.h"
+#include "capture.h"
+#include "platform.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#define MAX_TYPES 64
+
+typedef struct {
+	uint64_t timeMicros;
+	uint16_t type;
+	uint16_t length;
+	const uint8_t* payload;
+	// The number of barriers recorded before this call
+	size_t phase;
+} Event;
+
+typedef struct {
+	uint64_t count;
+	uint64_t totalMicros;
+	uint64_t maxMicros;
+} CallStats;
+
+typedef struct {
+	std::vector<Event> events;
+	size_t next;
+	CallStats stats[MAX_TYPES];
+	uint64_t maxLagMicros;
+} Worker;
+
+static H6ACServer* Server = 0;
+static H6ACClientV2* Client = 0;
+static H6ACReport* Report = 0;
+static H6ACTransfer* Transfer = 0;
+static H6ACResumption* Resumption = 0;
+static int ClientVersion = 0;
+
+static std::atomic<uint64_t> Observed[MAX_TYPES];
+static uint64_t Recorded[MAX_TYPES];
+static uint64_t Skipped[MAX_TYPES];
+// Calls that depend on uncaptured data, by whether the agent accepted them when captured
+static uint64_t Unreplayable[MAX_TYPES][2];
+
+// Shared secrets, attestation tokens and resumption tickets aren't captured, so zeroes of the recorded length stand in for them
+static uint8_t Filler[0x10000];
+
+// Exported state and issued tickets are discarded, so each thread writes them over its own buffer
+static thread_local uint8_t Discard[0x10000];
+
+static const char* TypeName(uint16_t type) {
+	switch (type) {
+	case CAPTURE_SERVER_BEGIN: return "H6ACServer::begin";
+	case CAPTURE_SERVER_END: return "H6ACServer::end";
+	case CAPTURE_SERVER_REGISTER: return "H6ACServer::registerPlayer";
+	case CAPTURE_SERVER_UNREGISTER: return "H6ACServer::unregisterPlayer";
+	case CAPTURE_CLIENT_PLAYER_ID: return "H6ACClient::setPlayerUniqueID";
+	case CAPTURE_CLIENT_SECRET: return "H6ACClient::setSharedSecret";
+	case CAPTURE_CLIENT_ATTESTATION: return "H6ACClient::submitClientAttestation";
+	case CAPTURE_CLIENT_DISCONNECT: return "H6ACClient::disconnect";
+	case CAPTURE_CLIENT_RESUME: return "H6ACClient::submitResumptionTicket";
+	case CAPTURE_REPORT_PLAYER: return "H6ACReport::reportPlayer";
+	case CAPTURE_TRANSFER_EXPORT: return "H6ACTransfer::exportPlayer";
+	case CAPTURE_TRANSFER_IMPORT: return "H6ACTransfer::importPlayer";
+	case CAPTURE_RESUMPTION_LIFETIME: return "H6ACResumption::setTicketLifetime";
+	case CAPTURE_RESUMPTION_ISSUE: return "H6ACResumption::issueTicket";
+	case CAPTURE_RESUMPTION_RESUME: return "H6ACResumption::resumePlayer";
+	case CAPTURE_CALLBACK_KICK: return "kick callback";
+	case CAPTURE_CALLBACK_ATTESTATION: return "attestation callback";
+	case CAPTURE_CALLBACK_UPDATE: return "update callback";
+	default: return 0;
+	}
+}
+
+static bool IsCallback(uint16_t type) {
+	return type >= CAPTURE_CALLBACK_KICK;
+}
+
+static bool IsBarrier(uint16_t type) {
+	return type == CAPTURE_SERVER_BEGIN || type == CAPTURE_SERVER_END || type == CAPTURE_RESUMPTION_LIFETIME;
+}
+
+static bool IsClientCall(uint16_t type) {
+	return type >= CAPTURE_CLIENT_PLAYER_ID && type < CAPTURE_REPORT_PLAYER;
+}
+
+// Returns true for calls whose outcome depends on data that isn't captured, which are recorded with their result
+static bool IsUnreplayable(uint16_t type) {
+	return type == CAPTURE_TRANSFER_IMPORT || type == CAPTURE_RESUMPTION_RESUME;
+}
+
+// Returns false for calls the agent has no interface for
+static bool IsSupported(uint16_t type) {
+	if (type == CAPTURE_CLIENT_RESUME)
+		return ClientVersion >= 2;
+	if (type == CAPTURE_TRANSFER_EXPORT || type == CAPTURE_TRANSFER_IMPORT)
+		return Transfer != 0;
+	if (type >= CAPTURE_RESUMPTION_LIFETIME && type <= CAPTURE_RESUMPTION_RESUME)
+		return Resumption != 0;
+	return true;
+}
+
+static void* Acquired(void* iface) {
+	return iface != 0 && H6N_NO_ERROR(iface) ? iface : 0;
+}
+
+static H6N_PlayerID PayloadPlayer(const Event& event) {
+	H6N_PlayerID playerID;
+	memcpy(&playerID, event.payload, sizeof(playerID));
+	return playerID;
+}
+
+static uint32_t PayloadValue(const Event& event, uint32_t offset) {
+	uint32_t value;
+	memcpy(&value, event.payload + offset, sizeof(value));
+	return value;
+}
+
+// The recorded buffer length of an export or ticket issue, where zero means the call only queried the size
+static uint32_t DiscardLength(const Event& event) {
+	uint32_t length = PayloadValue(event, sizeof(H6N_PlayerID));
+	return length < sizeof(Discard) ? length : (uint32_t)sizeof(Discard);
+}
+
+static int OnKick(H6N_PlayerID, const char*) {
+	Observed[CAPTURE_CALLBACK_KICK]++;
+	return 1;
+}
+
+static void OnAttestation(H6N_PlayerID, uint8_t*, unsigned int) {
+	Observed[CAPTURE_CALLBACK_ATTESTATION]++;
+}
+
+static void OnUpdate() {
+	Observed[CAPTURE_CALLBACK_UPDATE]++;
+}
+
+static void Dispatch(const Event& event) {
+	switch (event.type) {
+	case CAPTURE_SERVER_BEGIN:
+		Server->begin(PayloadPlayer(event));
+		break;
+	case CAPTURE_SERVER_END:
+		Server->end();
+		break;
+	case CAPTURE_SERVER_REGISTER:
+		Server->registerPlayer(PayloadPlayer(event), Filler, PayloadValue(event, sizeof(H6N_PlayerID)));
+		break;
+	case CAPTURE_SERVER_UNREGISTER:
+		Server->unregisterPlayer(PayloadPlayer(event));
+		break;
+	case CAPTURE_CLIENT_PLAYER_ID:
+		Client->setPlayerUniqueID(PayloadPlayer(event));
+		break;
+	case CAPTURE_CLIENT_SECRET:
+		Client->setSharedSecret(Filler, PayloadValue(event, 0));
+		break;
+	case CAPTURE_CLIENT_ATTESTATION:
+		Client->submitClientAttestation(Filler, PayloadValue(event, 0));
+		break;
+	case CAPTURE_CLIENT_DISCONNECT:
+		Client->disconnect();
+		break;
+	case CAPTURE_CLIENT_RESUME:
+		Client->submitResumptionTicket(Filler, PayloadValue(event, 0));
+		break;
+	case CAPTURE_REPORT_PLAYER:
+		Report->reportPlayer(PayloadPlayer(event), (int)PayloadValue(event, sizeof(H6N_PlayerID)));
+		break;
+	case CAPTURE_TRANSFER_EXPORT: {
+		uint32_t length = DiscardLength(event);
+		Transfer->exportPlayer(PayloadPlayer(event), length != 0 ? Discard : 0, length);
+		break;
+	}
+	case CAPTURE_RESUMPTION_LIFETIME:
+		Resumption->setTicketLifetime(PayloadValue(event, 0));
+		break;
+	case CAPTURE_RESUMPTION_ISSUE: {
+		uint32_t length = DiscardLength(event);
+		Resumption->issueTicket(PayloadPlayer(event), length != 0 ? Discard : 0, length);
+		break;
+	}
+	}
+}
+
+static void RunEvent(Worker* worker, const Event& event, uint64_t startMicros, double speed) {
+	uint64_t due = startMicros + (uint64_t)(event.timeMicros / speed);
+	uint64_t now = Platform_tickMicros();
+	if (now < due) {
+		Platform_sleepMicros(due - now);
+		now = Platform_tickMicros();
+	}
+	if (now - due > worker->maxLagMicros)
+		worker->maxLagMicros = now - due;
+
+	Dispatch(event);
+
+	uint64_t elapsed = Platform_tickMicros() - now;
+	CallStats& stats = worker->stats[event.type];
+	stats.count++;
+	stats.totalMicros += elapsed;
+	if (elapsed > stats.maxMicros)
+		stats.maxMicros = elapsed;
+}
+
+// Replays the worker's calls up to the next barrier
+static void RunWorker(Worker* worker, size_t phase, uint64_t startMicros, double speed) {
+	for (; worker->next < worker->events.size() && worker->events[worker->next].phase == phase; worker->next++)
+		RunEvent(worker, worker->events[worker->next], startMicros, speed);
+}
+
+// Returns false if the capture is malformed
+static bool LoadEvents(const PlatformMappedFile& file, std::vector<Worker>& workers, std::vector<Event>& barriers) {
+	const uint8_t* data = (const uint8_t*)file.base;
+
+	CaptureHeader header;
+	if (file.size < sizeof(header))
+		return false;
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != CAPTURE_MAGIC || header.version != CAPTURE_VERSION)
+		return false;
+
+	size_t offset = sizeof(header);
+	while (offset + sizeof(CaptureRecord) <= file.size) {
+		CaptureRecord record;
+		memcpy(&record, data + offset, sizeof(record));
+		if (record.type == CAPTURE_NONE)
+			break;
+
+		size_t size = sizeof(record) + ((record.length + CAPTURE_ALIGN - 1) & ~(size_t)(CAPTURE_ALIGN - 1));
+		if (offset + size > file.size || record.type >= MAX_TYPES)
+			return false;
+
+		Event event;
+		event.timeMicros = record.timeMicros;
+		event.type = record.type;
+		event.length = record.length;
+		event.payload = data + offset + sizeof(record);
+		event.phase = barriers.size();
+		offset += size;
+
+		// Skip record types from newer SDKs
+		if (TypeName(event.type) == 0)
+			continue;
+
+		if (IsCallback(event.type)) {
+			Recorded[event.type]++;
+			continue;
+		}
+
+		if (IsUnreplayable(event.type)) {
+			if (event.length < sizeof(H6N_PlayerID) + 2 * sizeof(uint32_t))
+				return false;
+			Unreplayable[event.type][PayloadValue(event, sizeof(H6N_PlayerID) + sizeof(uint32_t)) != 0]++;
+			continue;
+		}
+
+		if (!IsSupported(event.type)) {
+			Skipped[event.type]++;
+			continue;
+		}
+
+		if (IsBarrier(event.type)) {
+			barriers.push_back(event);
+			continue;
+		}
+
+		// Keep each player's calls, and all of the client's calls, on one thread so they replay in order
+		size_t worker = 0;
+		if (!IsClientCall(event.type) && event.length >= sizeof(H6N_PlayerID)) {
+			H6N_PlayerID playerID = PayloadPlayer(event);
+			worker = (size_t)((playerID.of64.lo ^ playerID.of64.hi) % workers.size());
+		}
+		workers[worker].events.push_back(event);
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <capture file> [-speed <factor>] [-threads <count>]\n", argv[0]);
+		return 1;
+	}
+
+	double speed = 1;
+	int threads = 1;
+	for (int i = 2; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "-speed") == 0)
+			speed = atof(argv[i + 1]);
+		else if (strcmp(argv[i], "-threads") == 0)
+			threads = atoi(argv[i + 1]);
+	}
+	if (speed <= 0 || threads <= 0) {
+		fprintf(stderr, "Speed and thread count must be positive\n");
+		return 1;
+	}
+
+	PlatformMappedFile file;
+	if (!Platform_openMappedFile(&file, argv[1])) {
+		fprintf(stderr, "Could not open capture %s\n", argv[1]);
+		return 1;
+	}
+
+	H6N_initialize();
+
+	H6N_InterfaceRequest requests[] = {
+		{ H6AC_SERVER_INTERFACE, 1, 0 },
+		{ H6AC_CLIENT_INTERFACE, H6AC_CLIENT_V2_VERSION, 0 },
+		{ H6AC_REPORT_INTERFACE, 1, 0 },
+		{ H6AC_TRANSFER_INTERFACE, 1, 0 },
+		{ H6AC_RESUMPTION_INTERFACE, 1, 0 },
+	};
+	Agent_createInterfaces(requests, 5);
+
+	// Agents from before resumption tickets only provide version 1 of the client, whose functions version 2 starts with
+	ClientVersion = H6AC_CLIENT_V2_VERSION;
+	if (Acquired(requests[1].result) == 0) {
+		requests[1].result = Agent_createInterface(H6AC_CLIENT_INTERFACE, H6AC_CLIENT_VERSION);
+		ClientVersion = H6AC_CLIENT_VERSION;
+	}
+
+	Server = (H6ACServer*)Acquired(requests[0].result);
+	Client = (H6ACClientV2*)Acquired(requests[1].result);
+	Report = (H6ACReport*)Acquired(requests[2].result);
+	Transfer = (H6ACTransfer*)Acquired(requests[3].result);
+	Resumption = (H6ACResumption*)Acquired(requests[4].result);
+	if (Server == 0 || Client == 0 || Report == 0) {
+		fprintf(stderr, "Could not acquire the H6AC interfaces from %s\n", H6N_AGENT_MODULE);
+		return 1;
+	}
+
+	std::vector<Worker> workers(threads);
+	std::vector<Event> barriers;
+	if (!LoadEvents(file, workers, barriers)) {
+		fprintf(stderr, "%s is not a valid capture\n", argv[1]);
+		return 1;
+	}
+
+	Server->setKickCallback(OnKick);
+	Server->setAttestationCallback(OnAttestation);
+	Server->setUpdateCallback(OnUpdate);
+
+	uint64_t startMicros = Platform_tickMicros();
+	for (size_t phase = 0; phase <= barriers.size(); phase++) {
+		std::vector<std::thread> running;
+		for (Worker& worker : workers)
+			running.push_back(std::thread(RunWorker, &worker, phase, startMicros, speed));
+		for (std::thread& thread : running)
+			thread.join();
+
+		// Every worker is idle, so the barrier can be accounted to any of them
+		if (phase < barriers.size())
+			RunEvent(&workers[0], barriers[phase], startMicros, speed);
+	}
+	uint64_t elapsedMicros = Platform_tickMicros() - startMicros;
+
+	printf("Replayed in %.3fs at %gx speed across %d threads\n\n", elapsedMicros / 1e6, speed, threads);
+	printf("%-40s %10s %12s %12s\n", "Call", "Count", "Mean (us)", "Max (us)");
+
+	uint64_t maxLag = 0;
+	for (int type = 0; type < MAX_TYPES; type++) {
+		CallStats total = { 0, 0, 0 };
+		for (const Worker& worker : workers) {
+			total.count += worker.stats[type].count;
+			total.totalMicros += worker.stats[type].totalMicros;
+			if (worker.stats[type].maxMicros > total.maxMicros)
+				total.maxMicros = worker.stats[type].maxMicros;
+		}
+
+		if (total.count != 0)
+			printf("%-40s %10llu %12.1f %12llu\n", TypeName((uint16_t)type), (unsigned long long)total.count,
+				(double)total.totalMicros / total.count, (unsigned long long)total.maxMicros);
+	}
+
+	for (const Worker& worker : workers) {
+		if (worker.maxLagMicros > maxLag)
+			maxLag = worker.maxLagMicros;
+	}
+	printf("\nMaximum lag behind schedule: %lluus\n\n", (unsigned long long)maxLag);
+
+	printf("%-40s %10s %12s\n", "Callback", "Recorded", "Replayed");
+	for (int type = CAPTURE_CALLBACK_KICK; type <= CAPTURE_CALLBACK_UPDATE; type++)
+		printf("%-40s %10llu %12llu\n", TypeName((uint16_t)type), (unsigned long long)Recorded[type],
+			(unsigned long long)Observed[type].load());
+
+	bool unreplayed = false;
+	for (int type = 0; type < MAX_TYPES; type++) {
+		if (Unreplayable[type][0] == 0 && Unreplayable[type][1] == 0)
+			continue;
+
+		if (!unreplayed)
+			printf("\n%-40s %10s %12s\n", "Not replayed (uncaptured data)", "Accepted", "Rejected");
+		printf("%-40s %10llu %12llu\n", TypeName((uint16_t)type), (unsigned long long)Unreplayable[type][1],
+			(unsigned long long)Unreplayable[type][0]);
+		unreplayed = true;
+	}
+
+	bool skipped = false;
+	for (int type = 0; type < MAX_TYPES; type++) {
+		if (Skipped[type] == 0)
+			continue;
+
+		printf("%sSkipped %llu calls to %s, which %s doesn't provide\n", skipped ? "" : "\n",
+			(unsigned long long)Skipped[type], TypeName((uint16_t)type), H6N_AGENT_MODULE);
+		skipped = true;
+	}
+
+	Platform_freeMappedFile(&file, 0);
+	return 0;
+}